@@ -11,10 +11,36 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
+#include <unistd.h>
 #include "assert.h"
 #include "compress40.h"
+#include "stream40.h"
+#include "parallel40.h"
+#include "pipeline40.h"
+#include "blocked40.h"
+#include "batch40.h"
+#include "serve40.h"
+#include "wordIO.h"
+#include "rowCodec.h"
 
 static void (*compress_or_decompress)(FILE *input) = compress40;
+static bool stream = false;
+static bool blocked = false;
+static bool pipelined = false;
+static bool batch = false;
+static bool fixedPoint = false;
+static bool tableDecode = false;
+static bool hugePages = false;
+static unsigned threads = 0;
+static const unsigned long MAX_THREADS = 256;   /* most threads -j asks for */
+static char *servePath = NULL;
+static uint64_t maxRequest = SERVE_DEFAULT_MAX_PAYLOAD;
+
+static void usage(char *progname);
+static int runBatch(char **files, int count, char *progname);
+static int runServer(char *progname);
+static unsigned coreCount(void);
 
 int main(int argc, char *argv[])
 {
@@ -25,29 +51,189 @@ int main(int argc, char *argv[])
                         compress_or_decompress = compress40;
                 } else if (strcmp(argv[i], "-d") == 0) {
                         compress_or_decompress = decompress40;
+                } else if (strcmp(argv[i], "-n") == 0) {
+                        useNativeWords(true);
+                } else if (strcmp(argv[i], "-x") == 0) {
+                        fixedPoint = true;
+                        useFixedPoint(true);
+                } else if (strcmp(argv[i], "-t") == 0) {
+                        tableDecode = true;
+                        useTableDecode(true);
+                } else if (strcmp(argv[i], "-s") == 0) {
+                        stream = true;
+                } else if (strcmp(argv[i], "-p") == 0) {
+                        pipelined = true;
+                } else if (strcmp(argv[i], "-b") == 0) {
+                        blocked = true;
+                } else if (strcmp(argv[i], "-B") == 0) {
+                        batch = true;
+                } else if (strcmp(argv[i], "-H") == 0) {
+                        hugePages = true;
+                } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+                        servePath = argv[++i];
+                } else if (strcmp(argv[i], "--max-request") == 0 &&
+                           i + 1 < argc) {
+                        char *end, *arg = argv[++i];
+                        unsigned long long n = strtoull(arg, &end, 10);
+                        if (*arg == '-' || *end != '\0' || n < 1) {
+                                usage(argv[0]);
+                        }
+                        maxRequest = n;
+                } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+                        char *end, *arg = argv[++i];
+                        unsigned long n = strtoul(arg, &end, 10);
+                        if (*arg == '-' || *end != '\0' || n < 1 ||
+                            n > MAX_THREADS) {
+                                usage(argv[0]);
+                        }
+                        threads = n;
                 } else if (*argv[i] == '-') {
                         fprintf(stderr, "%s: unknown option '%s'\n",
                                 argv[0], argv[i]);
                         exit(1);
+                } else if (batch) {
+                        break;
                 } else if (argc - i > 2) {
-                        fprintf(stderr, "Usage: %s -d [filename]\n"
-                                "       %s -c [filename]\n",
-                                argv[0], argv[0]);
-                        exit(1);
+                        usage(argv[0]);
                 } else {
                         break;
                 }
         }
 
+        /* the decode tables are for the float codec */
+        if (fixedPoint && tableDecode) {
+                usage(argv[0]);
+        }
+
+        /* answer requests on a socket until stopped */
+        if (servePath != NULL) {
+                if (i < argc) {
+                        usage(argv[0]);
+                }
+                return runServer(argv[0]);
+        }
+
+        /* the decode tables are no use when compressing */
+        if (tableDecode && compress_or_decompress == compress40) {
+                usage(argv[0]);
+        }
+
+        /* work through a batch of files (or a list of them on stdin) */
+        if (batch) {
+                return runBatch(argv + i, argc - i, argv[0]);
+        }
+
+        /* huge pages are only for the codec contexts of -B and --serve */
+        if (hugePages) {
+                usage(argv[0]);
+        }
+        if (threads == 0) {
+                threads = 1;
+        }
+
+        /* a pipeline reads and writes as a stream, with its own threads */
+        if (pipelined && (stream || blocked)) {
+                usage(argv[0]);
+        }
+
+        /* unpack into a blocked pixmap if asked to (decompression only) */
+        if (blocked && (stream || threads > 1 || 
+                        compress_or_decompress == compress40)) {
+                usage(argv[0]);
+        } else if (blocked) {
+                compress_or_decompress = blockedDecompress40;
+        }
+
+        /* stream the image through row by row if asked to */
+        if (stream && threads > 1) {
+                usage(argv[0]);
+        } else if (stream && compress_or_decompress == compress40) {
+                compress_or_decompress = streamCompress40;
+        } else if (stream) {
+                compress_or_decompress = streamDecompress40;
+        }
+
         assert(argc - i <= 1);    /* at most one file on command line */
+        FILE *fp = stdin;
         if (i < argc) {
-                FILE *fp = fopen(argv[i], "r");
+                fp = fopen(argv[i], "r");
                 assert(fp != NULL);
+        }
+
+        /* pipeline the stages, or spread the work over a pool, if asked to */
+        if (pipelined && compress_or_decompress == compress40) {
+                pipelineCompress40(fp, threads);
+        } else if (pipelined) {
+                pipelineDecompress40(fp, threads);
+        } else if (threads > 1 && compress_or_decompress == compress40) {
+                parallelCompress40(fp, threads);
+        } else if (threads > 1) {
+                parallelDecompress40(fp, threads);
+        } else {
                 compress_or_decompress(fp);
+        }
+
+        if (fp != stdin) {
                 fclose(fp);
-        } else {
-                compress_or_decompress(stdin);
         }
 
         return EXIT_SUCCESS; 
 }
+
+static int runBatch(char **files, int count, char *progname)
+{
+        if (stream || blocked || pipelined) {
+                usage(progname);
+        }
+        if (threads == 0) {
+                threads = coreCount();
+        }
+        bool compress = compress_or_decompress == compress40;
+
+        /* with no files named, the paths are listed on stdin */
+        bool ok;
+        if (count > 0) {
+                ok = batch40(files, count, compress, threads, hugePages);
+        } else {
+                unsigned listed;
+                char **paths = readPathList(stdin, &listed);
+                ok = batch40(paths, listed, compress, threads, hugePages);
+                freePathList(&paths, listed);
+        }
+        return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int runServer(char *progname)
+{
+        if (stream || blocked || batch || pipelined) {
+                usage(progname);
+        }
+        if (threads == 0) {
+                threads = coreCount();
+        }
+        bool served = serve40(servePath, threads, maxRequest, hugePages);
+        return served ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static unsigned coreCount(void)
+{
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        if (cores > (long)MAX_THREADS) {
+                return MAX_THREADS;
+        }
+        return cores > 0 ? cores : 1;
+}
+
+static void usage(char *progname)
+{
+        fprintf(stderr, 
+                "Usage: %s -d [-s | -b | [-p] [-j threads]] [-x | -t] "
+                "[filename]\n"
+                "       %s -c [-s | [-p] [-j threads]] [-n] [-x] [filename]\n"
+                "       %s {-c [-n] [-x] | -d [-x | -t]} -B [-j threads] [-H] "
+                "[filename ...]\n"
+                "       %s --serve socket [-j threads] [--max-request bytes] "
+                "[-H] [-n] [-x | -t]\n",
+                progname, progname, progname, progname);
+        exit(1);
+}
@@ -4,12 +4,21 @@
  * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
  * Date: 10/18/2023
  * Summary: Converts the given pixel either from RGB color space to Component 
- *          Video space or Component Video space to RGB.
+ *          Video space or Component Video space to RGB. A whole scanline of 
+ *          raw samples can be converted to Component Video with a table of
+ *          the terms of every sample value, and a row of unpacked 2 by 2 
+ *          blocks can be converted to 8 bit RGB 4 blocks at a time with 
+ *          SSE2, both giving the exact floats of the single pixel versions.
  */
 
 #include "RGBcompvConvert.h"
+#include "fixedPoint.h"
 #include "assert.h"
+#include "mem.h"
 #include <math.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /* upper and lower bounds for component video */
 const int Y_UPPERBOUND = 1;
@@ -30,6 +39,33 @@ const float RED_Y = 1.0, RED_PB = 0.0, RED_PR = 1.402;
 const float GREEN_Y = 1.0, GREEN_PB = 0.344136, GREEN_PR = 0.714136;
 const float BLUE_Y = 1.0, BLUE_PB = 1.772, BLUE_PR = 0.0;
 
+/* the same conversion constants in millionths for the fixed point versions */
+const int64_t Y_RED_M = 299000, Y_GREEN_M = 587000, Y_BLUE_M = 114000;
+const int64_t PB_RED_M = -168736, PB_GREEN_M = 331264, PB_BLUE_M = 500000;
+const int64_t PR_RED_M = 500000, PR_GREEN_M = 418688, PR_BLUE_M = 81312;
+const int64_t RED_PR_M = 1402000, GREEN_PB_M = 344136, GREEN_PR_M = 714136;
+const int64_t BLUE_PB_M = 1772000;
+
+/* floats per sample value in a color table (Y, Pb, Pr and one spare) */
+#define CV_STRIDE 4
+
+/* 
+ * the y, pb and pr terms of every sample value as a red, green or blue 
+ * sample, CV_STRIDE floats each. The terms that RGBtoCompV subtracts are 
+ * stored negated, which adds up to exactly the same floats.
+ */
+struct colorTable {
+        int denominator;
+        float *red, *green, *blue;
+};
+
+/* helper funcs */
+static int loadSample(const unsigned char *raw, size_t sampleBytes, size_t i);
+static void storeBlock(const int *red, const int *green, const int *blue, 
+                       unsigned block, unsigned char **scanlines);
+static int64_t clampFixed(int64_t value, int64_t lower, int64_t upper);
+static int scaleFixed(int64_t value, int denominator);
+
 /*
  * Name: RGBtoCompV
  * Purpose: Convert the given RGB pixel to Component video respresentation and 
@@ -111,3 +147,427 @@ void CompVtoRGB(float *CompVpixel, int *RGBpixel, int denominator)
         RGBpixel[1] = (int)green;
         RGBpixel[2] = (int)blue;
 }
+
+/*
+ * Name: newColorTable
+ * Purpose: Work out the y, pb and pr terms of every sample value for the 
+ *          given denominator, so converting a pixel is a few loads and adds
+ * Parameters: 
+ *      int denominator : The max val of the ppm images to be converted
+ * Output: The new table, with an entry for every value a sample of that size
+ *         can hold (even past the denominator)
+ * Notes: The table must be freed with freeColorTable()
+ */
+struct colorTable *newColorTable(int denominator)
+{
+        assert(denominator > 0 && denominator <= 65535);
+        struct colorTable *table;
+        NEW(table);
+        table->denominator = denominator;
+
+        size_t samples = denominator < 256 ? 256 : 65536;
+        table->red = ALLOC(3 * samples * CV_STRIDE * sizeof(float));
+        table->green = table->red + samples * CV_STRIDE;
+        table->blue = table->green + samples * CV_STRIDE;
+
+        for (size_t s = 0; s < samples; ++s) {
+                /* scale the value like RGBtoCompV */
+                float value = s;
+                value /= denominator;
+
+                float *red = table->red + s * CV_STRIDE;
+                float *green = table->green + s * CV_STRIDE;
+                float *blue = table->blue + s * CV_STRIDE;
+                red[0] = Y_RED * value;
+                red[1] = PB_RED * value;
+                red[2] = PR_RED * value;
+                green[0] = Y_GREEN * value;
+                green[1] = -(PB_GREEN * value);
+                green[2] = -(PR_GREEN * value);
+                blue[0] = Y_BLUE * value;
+                blue[1] = PB_BLUE * value;
+                blue[2] = -(PR_BLUE * value);
+                red[3] = green[3] = blue[3] = 0;
+        }
+
+        return table;
+}
+
+/*
+ * Name: freeColorTable
+ * Purpose: Free the given color table
+ * Parameters: 
+ *      struct colorTable **table : A pointer to the table to free
+ * Output: n/a
+ * Effects: The table is freed and *table is set to NULL
+ */
+void freeColorTable(struct colorTable **table)
+{
+        assert(table != NULL && *table != NULL);
+        FREE((*table)->red);
+        FREE(*table);
+}
+
+/*
+ * Name: rowToCompV
+ * Purpose: Convert a whole scanline of raw RGB samples to Component video 
+ *          with the given table, giving exactly the values RGBtoCompV would
+ *          give for each pixel. With SSE2 the y, pb and pr of a pixel are 
+ *          added and clamped at once, and 4 pixels at a time are regrouped 
+ *          into plane order and stored as whole vectors.
+ * Parameters: 
+ *          const unsigned char *raw : The raw P6 samples of the scanline
+ *                size_t sampleBytes : The bytes per sample (2 are big endian)
+ *                    unsigned width : The number of pixels in the scanline
+ *      const struct colorTable *table : The terms for the denominator of the
+ *                                       image
+ *                float *Y, *Pb, *Pr : The rows of the planes to put the Y, pb
+ *                                     and pr values in
+ * Output: n/a
+ * Effects: The first width floats of each row are filled
+ */
+void rowToCompV(const unsigned char *raw, size_t sampleBytes, unsigned width,
+                const struct colorTable *table, float *Y, float *Pb, 
+                float *Pr)
+{
+        unsigned col = 0;
+
+#if defined(__SSE2__)
+        __m128 lower = _mm_setr_ps(Y_LOWERBOUND, PB_PR_LOWERBOUND, 
+                                   PB_PR_LOWERBOUND, 0);
+        __m128 upper = _mm_setr_ps(Y_UPPERBOUND, PB_PR_UPPERBOUND, 
+                                   PB_PR_UPPERBOUND, 0);
+        for (; col + 4 <= width; col += 4) {
+                __m128 cv[4];
+                for (int i = 0; i < 4; ++i) {
+                        /* look up the terms of the red, green and blue */
+                        size_t sample = (col + i) * 3;
+                        const float *red = table->red + CV_STRIDE * 
+                                loadSample(raw, sampleBytes, sample);
+                        const float *green = table->green + CV_STRIDE * 
+                                loadSample(raw, sampleBytes, sample + 1);
+                        const float *blue = table->blue + CV_STRIDE * 
+                                loadSample(raw, sampleBytes, sample + 2);
+
+                        /* add them in the same order and clamp them */
+                        cv[i] = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(red), 
+                                                      _mm_loadu_ps(green)), 
+                                           _mm_loadu_ps(blue));
+                        cv[i] = _mm_min_ps(upper, _mm_max_ps(lower, cv[i]));
+                }
+
+                /* regroup the 4 pixels into their y, pb and pr */
+                _MM_TRANSPOSE4_PS(cv[0], cv[1], cv[2], cv[3]);
+                _mm_storeu_ps(Y + col, cv[0]);
+                _mm_storeu_ps(Pb + col, cv[1]);
+                _mm_storeu_ps(Pr + col, cv[2]);
+        }
+#endif
+
+        /* the rest one pixel at a time, like RGBtoCompV */
+        for (; col < width; ++col) {
+                const float *red = table->red + 
+                        loadSample(raw, sampleBytes, col * 3) * CV_STRIDE;
+                const float *green = table->green + 
+                        loadSample(raw, sampleBytes, col * 3 + 1) * CV_STRIDE;
+                const float *blue = table->blue + 
+                        loadSample(raw, sampleBytes, col * 3 + 2) * CV_STRIDE;
+
+                float y = (red[0] + green[0]) + blue[0];
+                float pb = (red[1] + green[1]) + blue[1];
+                float pr = (red[2] + green[2]) + blue[2];
+                Y[col] = fmin(Y_UPPERBOUND, fmax(Y_LOWERBOUND, y));
+                Pb[col] = fmin(PB_PR_UPPERBOUND, fmax(PB_PR_LOWERBOUND, pb));
+                Pr[col] = fmin(PB_PR_UPPERBOUND, fmax(PB_PR_LOWERBOUND, pr));
+        }
+}
+
+
+/*
+ * Name: blocksToRGB
+ * Purpose: Convert a row of unpacked 2 by 2 blocks (4 Y values and the pb and
+ *          pr shared by the block) given as planes to RGB, giving exactly the
+ *          values CompVtoRGB would give for each pixel of the block. The 
+ *          chroma terms are worked out once per block, and with SSE2 the 
+ *          pixels of 4 blocks are converted at once.
+ * Parameters: 
+ *      const struct blockPlanes *blocks : The unpacked blocks
+ *                        unsigned count : The number of blocks
+ *                       int denominator : The max val of the image being 
+ *                                         written (one byte per sample)
+ *            unsigned char **scanlines : The BLOCK_LENGTH scanlines of raw 
+ *                                         P6 samples to put the pixels in
+ * Output: n/a
+ * Effects: The first count 2 by 2 blocks of the scanlines are filled
+ * Expectations: The denominator is at most 255. CRE if not.
+ */
+void blocksToRGB(const struct blockPlanes *blocks, unsigned count, 
+                 int denominator, unsigned char **scanlines)
+{
+        assert(denominator > 0 && denominator <= 255);
+        unsigned b = 0;
+
+#if defined(__SSE2__)
+        __m128 den = _mm_set1_ps(denominator);
+        __m128 lower = _mm_set1_ps(RGB_LOWERBOUND);
+        for (; b + 4 <= count; b += 4) {
+                /* the chroma terms of the 4 blocks */
+                __m128 pb = _mm_loadu_ps(blocks->pbAvg + b);
+                __m128 pr = _mm_loadu_ps(blocks->prAvg + b);
+                __m128 redPb = _mm_mul_ps(_mm_set1_ps(RED_PB), pb);
+                __m128 redPr = _mm_mul_ps(_mm_set1_ps(RED_PR), pr);
+                __m128 greenPb = _mm_mul_ps(_mm_set1_ps(GREEN_PB), pb);
+                __m128 greenPr = _mm_mul_ps(_mm_set1_ps(GREEN_PR), pr);
+                __m128 bluePb = _mm_mul_ps(_mm_set1_ps(BLUE_PB), pb);
+                __m128 bluePr = _mm_mul_ps(_mm_set1_ps(BLUE_PR), pr);
+
+                /* 
+                 * one pixel of each block at a time. Blue is done in double
+                 * by CompVtoRGB, but y and a float product always sum 
+                 * exactly (or to within the float rounding) there, and the 
+                 * last term is a zero, so rounding once in float gives the 
+                 * same value.
+                 */
+                const float *planes[4] = { blocks->Y1, blocks->Y2, 
+                                           blocks->Y3, blocks->Y4 };
+                __m128 red[4], green[4], blue[4];
+                for (int i = 0; i < 4; ++i) {
+                        __m128 y = _mm_loadu_ps(planes[i] + b);
+                        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(
+                                _mm_set1_ps(RED_Y), y), redPb), redPr);
+                        __m128 g = _mm_sub_ps(_mm_sub_ps(_mm_mul_ps(
+                                _mm_set1_ps(GREEN_Y), y), greenPb), greenPr);
+                        __m128 bl = _mm_add_ps(_mm_add_ps(y, bluePb), bluePr);
+
+                        /* scale and clamp them like CompVtoRGB */
+                        red[i] = _mm_min_ps(den, _mm_max_ps(lower, 
+                                                    _mm_mul_ps(r, den)));
+                        green[i] = _mm_min_ps(den, _mm_max_ps(lower, 
+                                                      _mm_mul_ps(g, den)));
+                        blue[i] = _mm_min_ps(den, _mm_max_ps(lower, 
+                                                     _mm_mul_ps(bl, den)));
+                }
+
+                /* regroup the pixels by block, truncate and store them */
+                _MM_TRANSPOSE4_PS(red[0], red[1], red[2], red[3]);
+                _MM_TRANSPOSE4_PS(green[0], green[1], green[2], green[3]);
+                _MM_TRANSPOSE4_PS(blue[0], blue[1], blue[2], blue[3]);
+                for (int j = 0; j < 4; ++j) {
+                        int r[4], g[4], bl[4];
+                        _mm_storeu_si128((__m128i *)r, 
+                                         _mm_cvttps_epi32(red[j]));
+                        _mm_storeu_si128((__m128i *)g, 
+                                         _mm_cvttps_epi32(green[j]));
+                        _mm_storeu_si128((__m128i *)bl, 
+                                         _mm_cvttps_epi32(blue[j]));
+                        storeBlock(r, g, bl, b + j, scanlines);
+                }
+        }
+#endif
+
+        /* the rest one block at a time */
+        int red[4], green[4], blue[4];
+        for (; b < count; ++b) {
+
+                /* the chroma terms are the same for every pixel */
+                float pb = blocks->pbAvg[b], pr = blocks->prAvg[b];
+                float redPb = RED_PB * pb, redPr = RED_PR * pr;
+                float greenPb = GREEN_PB * pb, greenPr = GREEN_PR * pr;
+                float bluePb = BLUE_PB * pb, bluePr = BLUE_PR * pr;
+
+                float y[4] = { blocks->Y1[b], blocks->Y2[b], blocks->Y3[b], 
+                               blocks->Y4[b] };
+                for (int i = 0; i < 4; ++i) {
+                        float r = (RED_Y * y[i]) + redPb + redPr;
+                        float g = (GREEN_Y * y[i]) - greenPb - greenPr;
+                        float bl = (1.0 * y[i]) + bluePb + bluePr;
+
+                        r = fmin(denominator, fmax(RGB_LOWERBOUND, 
+                                                   r * denominator));
+                        g = fmin(denominator, fmax(RGB_LOWERBOUND, 
+                                                   g * denominator));
+                        bl = fmin(denominator, fmax(RGB_LOWERBOUND, 
+                                                    bl * denominator));
+                        red[i] = (int)r;
+                        green[i] = (int)g;
+                        blue[i] = (int)bl;
+                }
+
+                storeBlock(red, green, blue, b, scanlines);
+        }
+}
+
+/*
+ * Name: rowToCompVFixed
+ * Purpose: Convert a whole scanline of raw RGB samples to fixed point 
+ *          Component video using only integer math
+ * Parameters: 
+ *      const unsigned char *raw : The raw P6 samples of the scanline
+ *            size_t sampleBytes : The bytes per sample (2 are big endian)
+ *                unsigned width : The number of pixels in the scanline
+ *               int denominator : The max val of the ppm image, used to 
+ *                                 scale the values
+ *          int32_t *Y, *Pb, *Pr : The rows of the planes to put the Y, pb
+ *                                 and pr values (scaled by 2^FIXED_SHIFT) in
+ * Output: n/a
+ * Effects: The first width ints of each row are filled
+ */
+void rowToCompVFixed(const unsigned char *raw, size_t sampleBytes, 
+                     unsigned width, int denominator, int32_t *Y, 
+                     int32_t *Pb, int32_t *Pr)
+{
+        /* fold the scaling by the denominator into the coefficients (Q32) */
+        const int coefShift = 2 * FIXED_SHIFT;
+        int64_t yR = fixedCoef(Y_RED_M, coefShift, denominator);
+        int64_t yG = fixedCoef(Y_GREEN_M, coefShift, denominator);
+        int64_t yB = fixedCoef(Y_BLUE_M, coefShift, denominator);
+        int64_t pbR = fixedCoef(PB_RED_M, coefShift, denominator);
+        int64_t pbG = fixedCoef(PB_GREEN_M, coefShift, denominator);
+        int64_t pbB = fixedCoef(PB_BLUE_M, coefShift, denominator);
+        int64_t prR = fixedCoef(PR_RED_M, coefShift, denominator);
+        int64_t prG = fixedCoef(PR_GREEN_M, coefShift, denominator);
+        int64_t prB = fixedCoef(PR_BLUE_M, coefShift, denominator);
+
+        for (unsigned col = 0; col < width; ++col) {
+                int64_t red = loadSample(raw, sampleBytes, col * 3);
+                int64_t green = loadSample(raw, sampleBytes, col * 3 + 1);
+                int64_t blue = loadSample(raw, sampleBytes, col * 3 + 2);
+
+                /* convert to y pb and pr, then back down to FIXED_SHIFT */
+                int64_t y = (yR * red) + (yG * green) + (yB * blue);
+                int64_t pb = (pbR * red) - (pbG * green) + (pbB * blue);
+                int64_t pr = (prR * red) - (prG * green) - (prB * blue);
+                y = roundShift(y, FIXED_SHIFT);
+                pb = roundShift(pb, FIXED_SHIFT);
+                pr = roundShift(pr, FIXED_SHIFT);
+
+                /* ensure vals stay in range */
+                Y[col] = clampFixed(y, Y_LOWERBOUND * FIXED_ONE, 
+                                    Y_UPPERBOUND * FIXED_ONE);
+                Pb[col] = clampFixed(pb, -FIXED_ONE / 2, FIXED_ONE / 2);
+                Pr[col] = clampFixed(pr, -FIXED_ONE / 2, FIXED_ONE / 2);
+        }
+}
+
+/*
+ * Name: blocksToRGBFixed
+ * Purpose: Convert a row of fixed point unpacked 2 by 2 blocks to RGB using 
+ *          only integer math. The chroma terms are worked out once per block.
+ * Parameters: 
+ *      const struct fixedVals *blocks : The unpacked blocks
+ *                      unsigned count : The number of blocks
+ *                     int denominator : The max val of the image being 
+ *                                       written (one byte per sample)
+ *          unsigned char **scanlines : The BLOCK_LENGTH scanlines of raw P6 
+ *                                       samples to put the pixels in
+ * Output: n/a
+ * Effects: The first count 2 by 2 blocks of the scanlines are filled
+ * Expectations: The denominator is at most 255. CRE if not.
+ */
+void blocksToRGBFixed(const struct fixedVals *blocks, unsigned count, 
+                      int denominator, unsigned char **scanlines)
+{
+        assert(denominator > 0 && denominator <= 255);
+        int64_t redPr = fixedCoef(RED_PR_M, FIXED_SHIFT, 1);
+        int64_t greenPb = fixedCoef(GREEN_PB_M, FIXED_SHIFT, 1);
+        int64_t greenPr = fixedCoef(GREEN_PR_M, FIXED_SHIFT, 1);
+        int64_t bluePb = fixedCoef(BLUE_PB_M, FIXED_SHIFT, 1);
+
+        int red[4], green[4], blue[4];
+        for (unsigned b = 0; b < count; ++b) {
+
+                /* the chroma terms are the same for every pixel (Q32) */
+                int64_t pb = blocks[b].pbAvg, pr = blocks[b].prAvg;
+                int64_t redC = redPr * pr;
+                int64_t greenC = (greenPb * pb) + (greenPr * pr);
+                int64_t blueC = bluePb * pb;
+
+                const int32_t *y = &blocks[b].Y1;
+                for (int i = 0; i < 4; ++i) {
+                        int64_t luma = (int64_t)y[i] * FIXED_ONE;
+                        red[i] = scaleFixed(luma + redC, denominator);
+                        green[i] = scaleFixed(luma - greenC, denominator);
+                        blue[i] = scaleFixed(luma + blueC, denominator);
+                }
+
+                storeBlock(red, green, blue, b, scanlines);
+        }
+}
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: loadSample
+ * Purpose: Get the given raw sample of a scanline as an int
+ * Parameters: 
+ *      const unsigned char *raw : The raw P6 samples of the scanline
+ *            size_t sampleBytes : The bytes per sample (2 are big endian)
+ *                      size_t i : The index of the sample
+ * Output: The value of the sample
+ */
+int loadSample(const unsigned char *raw, size_t sampleBytes, size_t i)
+{
+        if (sampleBytes == 1) {
+                return raw[i];
+        }
+        return (raw[2 * i] << 8) | raw[2 * i + 1];
+}
+
+/*
+ * Name: storeBlock
+ * Purpose: Put the 4 converted pixels of a 2 by 2 block into the scanlines as
+ *          raw one byte samples
+ * Parameters: 
+ *      const int *red, *green, *blue : The samples of the 4 pixels, in block
+ *                                      order (top left, top right, bottom 
+ *                                      left, bottom right)
+ *                     unsigned block : The index of the block in the row
+ *          unsigned char **scanlines : The BLOCK_LENGTH scanlines to fill
+ * Output: n/a
+ */
+void storeBlock(const int *red, const int *green, const int *blue, 
+                unsigned block, unsigned char **scanlines)
+{
+        for (int i = 0; i < 4; ++i) {
+                unsigned char *pixel = scanlines[i / 2] + 
+                                       (block * 2 + i % 2) * 3;
+                pixel[0] = red[i];
+                pixel[1] = green[i];
+                pixel[2] = blue[i];
+        }
+}
+
+/*
+ * Name: clampFixed
+ * Purpose: Keep the given fixed point value inside the given range
+ * Parameters: 
+ *      int64_t value : The value to clamp
+ *      int64_t lower : The smallest value allowed
+ *      int64_t upper : The largest value allowed
+ * Output: The clamped value
+ */
+int64_t clampFixed(int64_t value, int64_t lower, int64_t upper)
+{
+        if (value < lower) {
+                return lower;
+        }
+        return value > upper ? upper : value;
+}
+
+/*
+ * Name: scaleFixed
+ * Purpose: Scale a fixed point (2^(2 * FIXED_SHIFT)) color value to a sample
+ *          between 0 and the denominator, truncating like CompVtoRGB
+ * Parameters: 
+ *        int64_t value : The red, green or blue value, where 1.0 is 2^32
+ *      int denominator : The max val of the image
+ * Output: The sample
+ */
+int scaleFixed(int64_t value, int denominator)
+{
+        value = clampFixed(value * denominator, 0, 
+                           (int64_t)denominator << (2 * FIXED_SHIFT));
+        return value >> (2 * FIXED_SHIFT);
+}
@@ -4,15 +4,37 @@
  * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)v
  * Date: 10/18/23
  * Summary: Provides user with the functions to convert a single 12 byte RGB 
- *          pixel to Componet video form and vice versa.
+ *          pixel to Componet video form and vice versa, to convert a whole 
+ *          scanline of raw RGB samples to rows of Component video planes at 
+ *          once (with a table made for the image's denominator), and to turn
+ *          a row of unpacked blocks straight into 8 bit RGB samples, in float
+ *          or in fixed point.
 */
 
 #ifndef RGBCOMPVCONVERT_H_INCLUDED
 #define RGBCOMPVCONVERT_H_INCLUDED
 
 #include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "packInfo.h"
+
+/* the Y, Pb and Pr terms of every sample value for one denominator */
+struct colorTable;
 
 void RGBtoCompV(int *RGBpixel, float *CompVpixel, int denominator);
 void CompVtoRGB(float *CompVpixel, int *RGBpixel, int denominator);
+struct colorTable *newColorTable(int denominator);
+void freeColorTable(struct colorTable **table);
+void rowToCompV(const unsigned char *raw, size_t sampleBytes, unsigned width,
+                const struct colorTable *table, float *Y, float *Pb, 
+                float *Pr);
+void blocksToRGB(const struct blockPlanes *blocks, unsigned count, 
+                 int denominator, unsigned char **scanlines);
+void rowToCompVFixed(const unsigned char *raw, size_t sampleBytes, 
+                     unsigned width, int denominator, int32_t *Y, 
+                     int32_t *Pb, int32_t *Pr);
+void blocksToRGBFixed(const struct fixedVals *blocks, unsigned count, 
+                      int denominator, unsigned char **scanlines);
 
 #endif
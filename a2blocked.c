@@ -0,0 +1,192 @@
+/*
+ * Assignment: arith
+ * Name: a2blocked.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/28/23
+ * Summary: This file implements the A2Methods interface for the UArray2b 
+ *          type. It contains static methods that call into UArray2b and 
+ *          provides an exported pointer to a struct so that the client uses 
+ *          the A2Methods function pointers instead of directly accessing the
+ *          UArray2b. A blocked array can only be mapped block major, so the 
+ *          row and column major maps are NULL.
+ */
+
+#include <stdlib.h>
+#include <a2blocked.h>
+#include "uarray2b.h"
+
+/************************************************/
+/* Define a private version of each function in */
+/* A2Methods_T that we implement.               */
+/************************************************/
+
+typedef A2Methods_UArray2 A2;   /* private abbreviation */
+
+/*
+ * new
+ * purpose: makes a new UArray2b with specified dimensions and element size,
+ *          with the largest blocks that fit in 64KB
+ * parameters:
+ *          int width: the desired width of the UArray2b
+ *         int height: the desired height of the UArray2b
+ *           int size: the number of bytes of each element of the UArray2b
+ * output: Returns the newly created UArray2b
+ * expectations: N/A
+ */
+static A2 new(int width, int height, int size)
+{
+        return UArray2b_new_64K_block(width, height, size);
+}
+
+/*
+ * new_with_blocksize
+ * purpose: makes a new UArray2b with specified dimensions, element size and
+ *          block size
+ * parameters:
+ *          int width: the desired width of the UArray2b
+ *         int height: the desired height of the UArray2b
+ *           int size: the number of bytes of each element of the UArray2b
+ *      int blocksize: the length of a block
+ * output: Returns the newly created UArray2b
+ * expectations: N/A
+ */
+static A2 new_with_blocksize(int width, int height, int size, int blocksize)
+{
+        return UArray2b_new(width, height, size, blocksize);
+}
+
+/*
+ * a2free
+ * purpose: frees the memory associated with a UArray2b
+ * parameters:
+ *          A2 *array2p: A pointer to the UArray2b_T to be freed
+ * output: none
+ * expectations: N/A
+ */
+static void a2free(A2 *array2p)
+{
+        UArray2b_free((UArray2b_T *) array2p);
+}
+
+/*
+ * width
+ * purpose: gets the width of a UArray2b
+ * parameters:
+ *          A2 array2: A pointer to a UArray2b to be accessed
+ * output: Returns the width of the array
+ * expectations: N/A
+ */
+static int width(A2 array2)
+{
+        return UArray2b_width(array2);
+}
+
+/*
+ * height
+ * purpose: gets the height of a UArray2b
+ * parameters:
+ *          A2 array2: A pointer to a UArray2b to be accessed
+ * output: Returns the height of the array
+ * expectations: N/A
+ */
+static int height(A2 array2)
+{
+        return UArray2b_height(array2);
+}
+
+/*
+ * size
+ * purpose: gets the integer byte size of an element of a UArray2b
+ * parameters:
+ *          A2 array2: A pointer to a UArray2b to be accessed
+ * output: Returns the integer byte size of each element of a UArray2b
+ * expectations: N/A
+ */
+static int size(A2 array2)
+{
+        return UArray2b_size(array2);
+}
+
+/*
+ * blocksize
+ * purpose: gets the block size of a UArray2b
+ * parameters:
+ *          A2 array2: A pointer to a UArray2b to be accessed
+ * output: Returns the number of cells along each side of a block
+ * expectations: N/A
+ */
+static int blocksize(A2 array2)
+{
+        return UArray2b_blocksize(array2);
+}
+
+/*
+ * at
+ * purpose: gets the element at a specified location in a UArray2b
+ * parameters:
+ *          A2 array2: A pointer to a UArray2b to be accessed
+ *              int i: The desired column of the element
+ *              int j: The desired row of the element
+ * output: Returns a pointer to the element stored at the specified col/row of
+ *         the UArray2b
+ * expectations: N/A
+ */
+static A2Methods_Object *at(A2 array2, int i, int j)
+{
+        return UArray2b_at(array2, i, j);
+}
+
+typedef void applyfun(int i, int j, UArray2b_T array2b, void *elem, void *cl);
+
+static void map_block_major(A2Methods_UArray2 uarray2,
+                            A2Methods_applyfun apply,
+                            void *cl)
+{
+        UArray2b_map(uarray2, (applyfun *)apply, cl);
+}
+
+struct small_closure {
+        A2Methods_smallapplyfun *apply; 
+        void                    *cl;
+};
+
+static void apply_small(int i, int j, UArray2b_T uarray2,
+                        void *elem, void *vcl)
+{
+        struct small_closure *cl = vcl;
+        (void)i;
+        (void)j;
+        (void)uarray2;
+        cl->apply(elem, cl->cl);
+}
+
+static void small_map_block_major(A2Methods_UArray2        a2,
+                                  A2Methods_smallapplyfun  apply,
+                                  void *cl)
+{
+        struct small_closure mycl = { apply, cl };
+        UArray2b_map(a2, apply_small, &mycl);
+}
+
+/* a struct containing A2Methods function pointers, to be used by the client */
+static struct A2Methods_T uarray2_methods_blocked_struct = {
+        new,
+        new_with_blocksize,
+        a2free,
+        width,
+        height,
+        size,
+        blocksize,
+        at,
+        NULL,                   /* map_row_major */
+        NULL,                   /* map_col_major */
+        map_block_major,
+        map_block_major,        /* map_default */
+        NULL,                   /* small_map_row_major */
+        NULL,                   /* small_map_col_major */
+        small_map_block_major,
+        small_map_block_major,  /* small_map_default */
+};
+
+/* exported pointer to the struct */
+A2Methods_T uarray2_methods_blocked = &uarray2_methods_blocked_struct;
@@ -0,0 +1,163 @@
+/*
+ * Assignment: arith
+ * Name: arena.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/29/23
+ * Summary: Implements the scratch arena with one anonymous mapping. Resetting
+ *          the arena takes back every buffer and makes sure the mapping can 
+ *          hold the next batch of them, growing it (to at least double its 
+ *          size) only when it can't. Arenas made for huge pages ask the 
+ *          kernel to back mappings of a huge page or more with them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "arena.h"
+#include "mem.h"
+#include "assert.h"
+
+/* size of a (transparent) huge page on the hosts we run on */
+static const size_t HUGE_PAGE_BYTES = 2 << 20;
+
+struct arena {
+        unsigned char *base;            /* the mapping (NULL if none yet) */
+        size_t capacity;                /* bytes in the mapping */
+        size_t used;                    /* bytes handed out since the reset */
+        bool hugePages;
+};
+
+/* helper funcs */
+static void mapArena(struct arena *arena, size_t bytes);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: newArena
+ * Purpose: Create an empty arena
+ * Parameters:
+ *      bool hugePages : Whether large mappings should be backed by huge 
+ *                       pages (when the kernel allows it)
+ * Output: The new arena, which maps nothing until its first reset
+ * Notes: The arena must be freed with freeArena()
+ */
+struct arena *newArena(bool hugePages)
+{
+        struct arena *arena;
+        NEW(arena);
+        arena->base = NULL;
+        arena->capacity = 0;
+        arena->used = 0;
+        arena->hugePages = hugePages;
+        return arena;
+}
+
+/*
+ * Name: resetArena
+ * Purpose: Take back every buffer handed out by the arena and make room for
+ *          the given number of bytes of new ones
+ * Parameters:
+ *      struct arena *arena : The arena to reset
+ *             size_t bytes : The room needed, the sum of the arenaSpace() of
+ *                            every buffer to be allocated before the next 
+ *                            reset
+ * Output: n/a
+ * Effects: Every pointer the arena handed out before is invalid. The mapping
+ *          is replaced only if it is too small.
+ */
+void resetArena(struct arena *arena, size_t bytes)
+{
+        assert(arena != NULL);
+        arena->used = 0;
+        if (bytes <= arena->capacity) {
+                return;
+        }
+
+        /* grow to at least double, so growing images remap only a few times */
+        size_t capacity = 2 * arena->capacity;
+        mapArena(arena, bytes > capacity ? bytes : capacity);
+}
+
+/*
+ * Name: arenaAlloc
+ * Purpose: Hand out a buffer from the arena
+ * Parameters:
+ *      struct arena *arena : The arena to allocate from
+ *             size_t bytes : The size of the buffer
+ * Output: A pointer to the buffer, aligned to ARENA_ALIGN bytes
+ * Expectations: The buffer fits in the room asked for at the last reset. CRE
+ *               if not.
+ */
+void *arenaAlloc(struct arena *arena, size_t bytes)
+{
+        assert(arena != NULL);
+        size_t space = arenaSpace(bytes);
+        assert(space <= arena->capacity - arena->used);
+
+        void *buffer = arena->base + arena->used;
+        arena->used += space;
+        return buffer;
+}
+
+/*
+ * Name: freeArena
+ * Purpose: Unmap the given arena and free it
+ * Parameters:
+ *      struct arena **arena : A pointer to the arena to free
+ * Output: n/a
+ * Effects: Every buffer of the arena is gone and *arena is set to NULL
+ */
+void freeArena(struct arena **arena)
+{
+        assert(arena != NULL && *arena != NULL);
+        if ((*arena)->base != NULL) {
+                munmap((*arena)->base, (*arena)->capacity);
+        }
+        FREE(*arena);
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: mapArena
+ * Purpose: Replace the mapping of the arena with one of at least the given
+ *          size (a whole number of pages, or of huge pages if the arena uses
+ *          them and the mapping is that big)
+ * Parameters:
+ *      struct arena *arena : The arena to remap
+ *             size_t bytes : The smallest size of the new mapping
+ * Output: n/a
+ * Effects: The old mapping is unmapped
+ * Expectations: The memory can be mapped. CRE if not.
+ */
+void mapArena(struct arena *arena, size_t bytes)
+{
+        if (arena->base != NULL) {
+                munmap(arena->base, arena->capacity);
+                arena->base = NULL;
+                arena->capacity = 0;
+        }
+
+        bool huge = arena->hugePages && bytes >= HUGE_PAGE_BYTES;
+        size_t page = huge ? HUGE_PAGE_BYTES : (size_t)sysconf(_SC_PAGESIZE);
+        size_t capacity = (bytes + page - 1) / page * page;
+        void *base = mmap(NULL, capacity, PROT_READ | PROT_WRITE, 
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        assert(base != MAP_FAILED);
+
+#if defined(MADV_HUGEPAGE)
+        if (huge) {
+                madvise(base, capacity, MADV_HUGEPAGE);
+        }
+#endif
+
+        arena->base = base;
+        arena->capacity = capacity;
+}
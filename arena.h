@@ -0,0 +1,41 @@
+/*
+ * Assignment: arith
+ * Name: arena.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/29/23
+ * Summary: Provides an arena of scratch memory that is handed out with a 
+ *          pointer bump and taken back all at once. The arena keeps its 
+ *          mapping between uses, so buffers carved out of it for one image 
+ *          are already faulted in for the next, and it is only remapped when
+ *          an image needs more room than it has.
+*/
+
+#ifndef ARENA_H_INCLUDED
+#define ARENA_H_INCLUDED
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* alignment in bytes of every buffer carved out of an arena */
+#define ARENA_ALIGN 64
+
+struct arena;
+
+/*
+ * Name: arenaSpace
+ * Purpose: Get the room a buffer of the given size takes up in an arena
+ * Parameters:
+ *      size_t bytes : The size of the buffer
+ * Output: bytes rounded up to a multiple of ARENA_ALIGN
+ */
+static inline size_t arenaSpace(size_t bytes)
+{
+        return (bytes + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+}
+
+struct arena *newArena(bool hugePages);
+void resetArena(struct arena *arena, size_t bytes);
+void *arenaAlloc(struct arena *arena, size_t bytes);
+void freeArena(struct arena **arena);
+
+#endif
@@ -0,0 +1,375 @@
+/*
+ * Assignment: arith
+ * Name: batch40.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/29/23
+ * Summary: Compresses or decompresses a batch of files on a pool of threads,
+ *          one whole file per thread at a time. Each thread keeps its own 
+ *          codec context, so its scratch memory stays warm from file to 
+ *          file. The files are sorted biggest first and dealt out to a queue
+ *          per thread. A thread works from the back of its own queue and, 
+ *          once that is empty, steals from the front of the others', so a 
+ *          few huge files don't leave the other threads idle at the end.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "batch40.h"
+#include "codecContext.h"
+#include "mem.h"
+#include "assert.h"
+
+/* 
+ * the files dealt to one thread, taken from the back by the thread and from 
+ * the front by thieves
+ */
+struct fileQueue {
+        unsigned *files;              /* indices into the batch's paths */
+        unsigned front, back;         /* files[front..back) are left */
+        pthread_mutex_t lock;
+};
+
+/* the work shared between the threads of a batch */
+struct batchWork {
+        char **paths;
+        bool compress;
+        unsigned threads;
+        bool hugePages;               /* for the threads' codec contexts */
+        struct fileQueue *queues;     /* one per thread */
+        pthread_mutex_t lock;         /* guards failed */
+        bool failed;
+};
+
+/* a thread of the pool and the work it shares */
+struct batchThread {
+        struct batchWork *work;
+        unsigned id;
+};
+
+/* a file and its size, for sorting the batch */
+struct sizedFile {
+        unsigned index;
+        off_t bytes;
+};
+
+/* helper funcs */
+static void dealFiles(struct batchWork *work, unsigned count);
+static int biggestFirst(const void *a, const void *b);
+static void *runBatch(void *thread);
+static bool takeFile(struct batchWork *work, unsigned id, unsigned *file);
+static bool processFile(struct codecContext *context, 
+                        struct batchWork *work, unsigned file);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: batch40
+ * Purpose: Compress or decompress every given file on a pool of threads. 
+ *          Compressing writes each file's words to its path plus 
+ *          COMPRESSED_SUFFIX, and decompressing writes each image to its 
+ *          path plus DECOMPRESSED_SUFFIX (nothing is overwritten in place).
+ * Parameters:
+ *           char **paths : The paths of the files
+ *         unsigned count : The number of paths
+ *          bool compress : Whether to compress (or decompress) the files
+ *       unsigned threads : The number of threads in the pool
+ *         bool hugePages : Whether big images' scratch memory should be 
+ *                          backed by huge pages (when the kernel allows it)
+ * Output: true if every file was opened and written, false if any couldn't
+ *         be (those are reported on stderr and skipped)
+ * Effects: The output files are created or replaced
+ * Expectations: threads is at least 1. CRE if not.
+ */
+bool batch40(char **paths, unsigned count, bool compress, unsigned threads,
+             bool hugePages)
+{
+        assert(threads >= 1);
+        if (threads > count) {
+                threads = count > 0 ? count : 1;
+        }
+
+        /* deal the files out to a queue per thread */
+        struct batchWork work;
+        work.paths = paths;
+        work.compress = compress;
+        work.threads = threads;
+        work.hugePages = hugePages;
+        work.failed = false;
+        pthread_mutex_init(&work.lock, NULL);
+        work.queues = ALLOC(threads * sizeof(*work.queues));
+        dealFiles(&work, count);
+
+        /* run the pool (one thread's work is done on this one) */
+        struct batchThread *pool = ALLOC(threads * sizeof(*pool));
+        pthread_t *ids = ALLOC(threads * sizeof(*ids));
+        for (unsigned i = 0; i < threads; ++i) {
+                pool[i].work = &work;
+                pool[i].id = i;
+        }
+        for (unsigned i = 1; i < threads; ++i) {
+                int err = pthread_create(&ids[i], NULL, runBatch, &pool[i]);
+                assert(err == 0);
+        }
+        runBatch(&pool[0]);
+        for (unsigned i = 1; i < threads; ++i) {
+                pthread_join(ids[i], NULL);
+        }
+
+        /* free the pool and the queues */
+        for (unsigned i = 0; i < threads; ++i) {
+                FREE(work.queues[i].files);
+                pthread_mutex_destroy(&work.queues[i].lock);
+        }
+        FREE(work.queues);
+        FREE(pool);
+        FREE(ids);
+        pthread_mutex_destroy(&work.lock);
+        return !work.failed;
+}
+
+/*
+ * Name: readPathList
+ * Purpose: Read a list of paths, one per line, from the given file
+ * Parameters:
+ *            FILE *fp : The file holding the list
+ *      unsigned *count : Where to store the number of paths read
+ * Output: The paths, with empty lines skipped
+ * Notes: The list must be freed with freePathList()
+ */
+char **readPathList(FILE *fp, unsigned *count)
+{
+        unsigned capacity = 16;
+        char **paths = ALLOC(capacity * sizeof(*paths));
+        *count = 0;
+
+        char *line = NULL;
+        size_t lineBytes = 0;
+        ssize_t length;
+        while ((length = getline(&line, &lineBytes, fp)) != -1) {
+                while (length > 0 && (line[length - 1] == '\n' || 
+                                      line[length - 1] == '\r')) {
+                        line[--length] = '\0';
+                }
+                if (length == 0) {
+                        continue;
+                }
+                if (*count == capacity) {
+                        capacity *= 2;
+                        RESIZE(paths, capacity * sizeof(*paths));
+                }
+                paths[*count] = ALLOC(length + 1);
+                memcpy(paths[*count], line, length + 1);
+                ++*count;
+        }
+
+        free(line);
+        return paths;
+}
+
+/*
+ * Name: freePathList
+ * Purpose: Free a list of paths made by readPathList
+ * Parameters:
+ *      char ***paths : A pointer to the list
+ *     unsigned count : The number of paths in it
+ * Output: n/a
+ * Effects: *paths is set to NULL
+ */
+void freePathList(char ***paths, unsigned count)
+{
+        assert(paths != NULL && *paths != NULL);
+        for (unsigned i = 0; i < count; ++i) {
+                FREE((*paths)[i]);
+        }
+        FREE(*paths);
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: dealFiles
+ * Purpose: Sort the files of the batch biggest first and deal them out to 
+ *          the threads' queues in turn, so every thread starts on big files 
+ *          and the small ones are left to fill in at the end
+ * Parameters:
+ *      struct batchWork *work : The batch, with its queues allocated
+ *              unsigned count : The number of files
+ * Output: n/a
+ * Effects: Each queue holds its share of the files, the biggest at the back
+ */
+void dealFiles(struct batchWork *work, unsigned count)
+{
+        struct sizedFile *files = ALLOC((count + 1) * sizeof(*files));
+        for (unsigned i = 0; i < count; ++i) {
+                struct stat info;
+                files[i].index = i;
+                files[i].bytes = stat(work->paths[i], &info) == 0 ? 
+                                 info.st_size : 0;
+        }
+        qsort(files, count, sizeof(*files), biggestFirst);
+
+        /* fill each queue from the back, so the owner takes its biggest */
+        unsigned share = (count + work->threads - 1) / work->threads;
+        for (unsigned t = 0; t < work->threads; ++t) {
+                struct fileQueue *queue = &work->queues[t];
+                queue->files = ALLOC((share + 1) * sizeof(unsigned));
+                queue->front = 0;
+                queue->back = 0;
+                pthread_mutex_init(&queue->lock, NULL);
+                for (unsigned i = t; i < count; i += work->threads) {
+                        queue->files[queue->back++] = files[i].index;
+                }
+
+                /* reverse so the biggest file is at the back */
+                for (unsigned i = 0; i < queue->back / 2; ++i) {
+                        unsigned tmp = queue->files[i];
+                        queue->files[i] = queue->files[queue->back - 1 - i];
+                        queue->files[queue->back - 1 - i] = tmp;
+                }
+        }
+
+        FREE(files);
+}
+
+/*
+ * Name: biggestFirst
+ * Purpose: qsort comparison that orders sizedFiles biggest first (and in the
+ *          order given when the sizes are equal)
+ * Parameters:
+ *      const void *a, *b : The sizedFiles to compare
+ * Output: Negative if a goes first, positive if b does
+ */
+int biggestFirst(const void *a, const void *b)
+{
+        const struct sizedFile *fileA = a, *fileB = b;
+        if (fileA->bytes != fileB->bytes) {
+                return fileA->bytes > fileB->bytes ? -1 : 1;
+        }
+        return fileA->index < fileB->index ? -1 : 1;
+}
+
+/*
+ * Name: runBatch
+ * Purpose: Run by each thread in the pool. Processes files until there are 
+ *          none left in any queue, with one codec context for all of them.
+ * Parameters:
+ *      void *thread : The batchThread of the calling thread
+ * Output: NULL
+ * Effects: The output of every file taken is written
+ */
+void *runBatch(void *thread)
+{
+        struct batchThread *self = thread;
+        struct codecContext *context = 
+                newCodecContext(self->work->hugePages);
+
+        unsigned file;
+        while (takeFile(self->work, self->id, &file)) {
+                if (!processFile(context, self->work, file)) {
+                        pthread_mutex_lock(&self->work->lock);
+                        self->work->failed = true;
+                        pthread_mutex_unlock(&self->work->lock);
+                }
+        }
+
+        freeCodecContext(&context);
+        return NULL;
+}
+
+/*
+ * Name: takeFile
+ * Purpose: Take the next file for the given thread: the back of its own 
+ *          queue, or else the front of another thread's
+ * Parameters:
+ *      struct batchWork *work : The batch
+ *                 unsigned id : The index of the calling thread
+ *              unsigned *file : Where to store the index of the file taken
+ * Output: true if a file was taken, false if every queue is empty
+ */
+bool takeFile(struct batchWork *work, unsigned id, unsigned *file)
+{
+        for (unsigned i = 0; i < work->threads; ++i) {
+                struct fileQueue *queue = &work->queues[(id + i) % 
+                                                        work->threads];
+                bool own = i == 0;
+                bool taken = false;
+
+                pthread_mutex_lock(&queue->lock);
+                if (queue->front < queue->back) {
+                        *file = own ? queue->files[--queue->back] 
+                                    : queue->files[queue->front++];
+                        taken = true;
+                }
+                pthread_mutex_unlock(&queue->lock);
+
+                if (taken) {
+                        return true;
+                }
+        }
+        return false;
+}
+
+/*
+ * Name: processFile
+ * Purpose: Compress or decompress one file of the batch to its derived path
+ * Parameters:
+ *      struct codecContext *context : The calling thread's context
+ *            struct batchWork *work : The batch
+ *                     unsigned file : The index of the file
+ * Output: true if the file was processed, false if it or its output 
+ *         couldn't be opened or written, or it isn't a well formed image 
+ *         (reported on stderr, and the output is removed)
+ */
+bool processFile(struct codecContext *context, struct batchWork *work, 
+                 unsigned file)
+{
+        const char *path = work->paths[file];
+        const char *suffix = work->compress ? COMPRESSED_SUFFIX 
+                                            : DECOMPRESSED_SUFFIX;
+        size_t length = strlen(path);
+        char *outPath = ALLOC(length + strlen(suffix) + 1);
+        memcpy(outPath, path, length);
+        strcpy(outPath + length, suffix);
+
+        bool ok = false;
+        bool wellFormed = true;
+        FILE *in = fopen(path, "rb");
+        FILE *out = in != NULL ? fopen(outPath, "wb") : NULL;
+        if (in != NULL && out != NULL) {
+                wellFormed = work->compress ? 
+                             contextCompress40(context, in, out) :
+                             contextDecompress40(context, in, out);
+                ok = wellFormed;
+        }
+        if (out != NULL && fclose(out) != 0) {
+                ok = false;
+        }
+        if (in != NULL) {
+                fclose(in);
+        }
+
+        /* report the file and leave no partial output behind */
+        if (!wellFormed) {
+                fprintf(stderr, "%s: not a well formed %s\n", path, 
+                        work->compress ? "ppm image" : "compressed image");
+        } else if (!ok) {
+                perror(in == NULL ? path : outPath);
+        }
+        if (!ok && out != NULL) {
+                remove(outPath);
+        }
+
+        FREE(outPath);
+        return ok;
+}
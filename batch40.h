@@ -0,0 +1,26 @@
+/*
+ * Assignment: arith
+ * Name: batch40.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/29/23
+ * Summary: Provides a batch mode that compresses or decompresses many files 
+ *          in one process, several files at a time on a pool of threads. 
+ *          Each file's output goes to a path derived from its own.
+*/
+
+#ifndef BATCH40_H_INCLUDED
+#define BATCH40_H_INCLUDED
+
+#include <stdio.h>
+#include <stdbool.h>
+
+/* suffixes added to the path of each file to get the path of its output */
+#define COMPRESSED_SUFFIX ".c40"
+#define DECOMPRESSED_SUFFIX ".ppm"
+
+bool batch40(char **paths, unsigned count, bool compress, unsigned threads,
+             bool hugePages);
+char **readPathList(FILE *fp, unsigned *count);
+void freePathList(char ***paths, unsigned count);
+
+#endif
@@ -0,0 +1,149 @@
+/*
+ * Assignment: arith
+ * Name: blocked40.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/28/23
+ * Summary: Decompresses a compressed file into a blocked pixmap (a UArray2b 
+ *          with BLOCK_LENGTH by BLOCK_LENGTH blocks behind the A2Methods 
+ *          interface). The pixmap is walked block major by a map made for 
+ *          this stage (the unpacking is inlined into the loop instead of 
+ *          called through A2Methods per pixel), so each word is unpacked 
+ *          into 12 contiguous bytes instead of into 2 rows. The 
+ *          blocks are then copied out a pair of scanlines at a time to be 
+ *          printed. The output is identical to decompress40.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "blocked40.h"
+#include "codeWord.h"
+#include "ppmIO.h"
+#include "rowCodec.h"
+#include "wordIO.h"
+#include "a2methods.h"
+#include "a2blocked.h"
+#include "uarray2b.h"
+#include "mem.h"
+
+/* used to help simplify the syntax */
+typedef A2Methods_UArray2 A2;
+#define Bmethods uarray2_methods_blocked
+
+/* helper funcs */
+static void printBlocks(A2 pixels);
+
+/*
+ * Name: unpackBlock
+ * Purpose: Unpack the word holding the given block of the pixmap into it
+ * Parameters:
+ *                     int col : Column of the top left pixel of the block
+ *                     int row : Row of the top left pixel of the block
+ *                 void *block : The BLOCK_LENGTH * BLOCK_LENGTH contiguous 
+ *                               pixels of the block
+ *      struct wordView *words : The view of bitpacked words to unpack
+ * Output: n/a
+ * Effects: The block is filled with its 8 bit R G B pixels
+ */
+static inline void unpackBlock(int col, int row, void *block, 
+                               struct wordView *words)
+{
+        /* the rows of a block are contiguous, so the block is its own rows */
+        codeWord word = wordAt(words, col / BLOCK_LENGTH, row / BLOCK_LENGTH);
+        unsigned char *scanlines[BLOCK_LENGTH];
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                scanlines[i] = (unsigned char *)block + 
+                               i * BLOCK_LENGTH * PIXEL_VALS;
+        }
+        unpackScanlines(&word, 1, scanlines);
+}
+
+/* the block major map of the pixmap with unpackBlock inlined */
+UARRAY2B_DEFINE_MAP_BLOCKS(unpackBlocksMajor, unpackBlock, struct wordView)
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: blockedDecompress40
+ * Purpose: Decompress the given file (32 bit words -> pixels) into a blocked
+ *          pixmap and print out the decompressed ppm image to stdout
+ * Parameters:
+ *      FILE *fp : A file pointer to the compressed ppm file
+ * Output: The decompressed file is written to stdout as a P6 ppm file exactly
+ *         as decompress40 would write it.
+ * Expectations: The given file pointer is formatted correctly. CRE if not.
+ */
+void blockedDecompress40(FILE *fp)
+{
+        /* read in header and map (or read in) the words */
+        unsigned height, width;
+        bool swap = readWordHeader(fp, &width, &height);
+        struct wordView words;
+        openWordView(fp, width, height, swap, &words);
+
+        /* unpack each word straight into its block of the pixmap */
+        A2 pixmap = Bmethods->new_with_blocksize(words.cols * BLOCK_LENGTH, 
+                                                 words.rows * BLOCK_LENGTH,
+                                                 PIXEL_VALS, BLOCK_LENGTH);
+        unpackBlocksMajor(pixmap, &words);
+
+        /* print the image and free the pixmap and the words */
+        printBlocks(pixmap);
+        closeWordView(&words);
+        Bmethods->free(&pixmap);
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: printBlocks
+ * Purpose: Print the blocked pixmap to stdout as a P6 ppm file, copying the 
+ *          rows of a row of blocks into a pair of scanlines at a time
+ * Parameters:
+ *      A2 pixels : The blocked pixmap of 8 bit R G B pixels
+ * Output: n/a
+ * Effects: The image is printed to stdout
+ */
+void printBlocks(A2 pixels)
+{
+        struct ppmHeader header = { Bmethods->width(pixels), 
+                                    Bmethods->height(pixels), DENOMINATOR,
+                                    false };
+        writePpmHeader(stdout, &header);
+
+        size_t rowBytes = header.width * PIXEL_VALS;
+        size_t blockRowBytes = BLOCK_LENGTH * PIXEL_VALS;
+        unsigned char *rows[BLOCK_LENGTH];
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                rows[i] = ALLOC(rowBytes + 1);
+        }
+
+        for (unsigned row = 0; row < header.height; row += BLOCK_LENGTH) {
+                for (unsigned col = 0; col < header.width; 
+                     col += BLOCK_LENGTH) {
+                        const unsigned char *block = Bmethods->at(pixels, col,
+                                                                  row);
+                        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                                memcpy(rows[i] + col * PIXEL_VALS, 
+                                       block + i * blockRowBytes, 
+                                       blockRowBytes);
+                        }
+                }
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        fwrite(rows[i], 1, rowBytes, stdout);
+                }
+        }
+
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                FREE(rows[i]);
+        }
+}
+
+#undef Bmethods
@@ -0,0 +1,17 @@
+/*
+ * Assignment: arith
+ * Name: blocked40.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/28/23
+ * Summary: Provides a version of decompress40 that unpacks into a blocked 
+ *          pixmap, where each 2 by 2 block of pixels is stored contiguously.
+*/
+
+#ifndef BLOCKED40_H_INCLUDED
+#define BLOCKED40_H_INCLUDED
+
+#include <stdio.h>
+
+void blockedDecompress40(FILE *fp);
+
+#endif
@@ -14,4 +14,10 @@
 
 typedef uint32_t codeWord;
 
+/* each codeWord holds a BLOCK_LENGTH by BLOCK_LENGTH block of pixels */
+static const int BLOCK_LENGTH = 2;
+
+/* max value of the RGB pixels of a decompressed image */
+static const int DENOMINATOR = 255;
+
 #endif
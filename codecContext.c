@@ -0,0 +1,138 @@
+/*
+ * Assignment: arith
+ * Name: codecContext.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/29/23
+ * Summary: Implements the codec context. Each piece of scratch memory is 
+ *          made the first time it is asked for and kept: the arena is reset
+ *          (and only grown when too small) for every image, the color table 
+ *          is rebuilt only when the denominator changes, and the frame only 
+ *          when an image is bigger than it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "codecContext.h"
+#include "mem.h"
+#include "assert.h"
+
+struct codecContext {
+        struct arena *arena;
+        struct colorTable *colors;      /* NULL until the first image */
+        int denominator;                /* the denominator of colors */
+        struct cvFrame *frame;          /* NULL until the first image */
+};
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: newCodecContext
+ * Purpose: Create a codec context that holds no scratch memory yet
+ * Parameters:
+ *      bool hugePages : Whether the arena should back large images with huge
+ *                       pages (when the kernel allows it)
+ * Output: The new context
+ * Notes: The context must be freed with freeCodecContext(). A context may 
+ *        only be used by one thread at a time.
+ */
+struct codecContext *newCodecContext(bool hugePages)
+{
+        struct codecContext *context;
+        NEW(context);
+        context->arena = newArena(hugePages);
+        context->colors = NULL;
+        context->denominator = 0;
+        context->frame = NULL;
+        return context;
+}
+
+/*
+ * Name: freeCodecContext
+ * Purpose: Free the given context and all of its scratch memory
+ * Parameters:
+ *      struct codecContext **context : A pointer to the context to free
+ * Output: n/a
+ * Effects: *context is set to NULL
+ */
+void freeCodecContext(struct codecContext **context)
+{
+        assert(context != NULL && *context != NULL);
+        struct codecContext *c = *context;
+        freeArena(&c->arena);
+        if (c->colors != NULL) {
+                freeColorTable(&c->colors);
+        }
+        if (c->frame != NULL) {
+                freeCvFrame(&c->frame);
+        }
+        FREE(*context);
+}
+
+/*
+ * Name: contextArena
+ * Purpose: Get the context's arena, emptied and with room for the given 
+ *          number of bytes of buffers
+ * Parameters:
+ *      struct codecContext *context : The context
+ *                      size_t bytes : The room needed (see resetArena)
+ * Output: The arena
+ * Effects: Every buffer handed out by the arena before is invalid
+ */
+struct arena *contextArena(struct codecContext *context, size_t bytes)
+{
+        assert(context != NULL);
+        resetArena(context->arena, bytes);
+        return context->arena;
+}
+
+/*
+ * Name: contextColors
+ * Purpose: Get a color table for the given denominator, reusing the last one
+ *          if it was made for the same denominator
+ * Parameters:
+ *      struct codecContext *context : The context
+ *                   int denominator : The max val of the image to convert
+ * Output: The color table, owned by the context
+ */
+const struct colorTable *contextColors(struct codecContext *context, 
+                                       int denominator)
+{
+        assert(context != NULL);
+        if (context->colors != NULL && context->denominator != denominator) {
+                freeColorTable(&context->colors);
+        }
+        if (context->colors == NULL) {
+                context->colors = newColorTable(denominator);
+                context->denominator = denominator;
+        }
+        return context->colors;
+}
+
+/*
+ * Name: contextFrame
+ * Purpose: Get a frame of at least the given size, reusing the last one if 
+ *          it is big enough
+ * Parameters:
+ *      struct codecContext *context : The context
+ *                    unsigned width : The smallest width needed in pixels
+ *                   unsigned height : The smallest height needed in pixels
+ * Output: The frame, owned by the context (its planes hold unset values)
+ */
+struct cvFrame *contextFrame(struct codecContext *context, unsigned width, 
+                             unsigned height)
+{
+        assert(context != NULL);
+        struct cvFrame *frame = context->frame;
+        if (frame != NULL && (frame->width < width || frame->height < height)) {
+                width = frame->width > width ? frame->width : width;
+                height = frame->height > height ? frame->height : height;
+                freeCvFrame(&context->frame);
+        }
+        if (context->frame == NULL) {
+                context->frame = newCvFrame(width, height);
+        }
+        return context->frame;
+}
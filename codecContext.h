@@ -0,0 +1,38 @@
+/*
+ * Assignment: arith
+ * Name: codecContext.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/29/23
+ * Summary: Provides a codec context, which owns the scratch memory of 
+ *          compressing and decompressing whole images (an arena sized from 
+ *          each image's header, the color table and the conversion frame) so
+ *          a process that works through many images reuses warm buffers 
+ *          instead of allocating fresh ones for each. compress40 and 
+ *          decompress40 are one use of a context.
+*/
+
+#ifndef CODECCONTEXT_H_INCLUDED
+#define CODECCONTEXT_H_INCLUDED
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "arena.h"
+#include "cvFrame.h"
+#include "RGBcompvConvert.h"
+
+struct codecContext;
+
+struct codecContext *newCodecContext(bool hugePages);
+void freeCodecContext(struct codecContext **context);
+struct arena *contextArena(struct codecContext *context, size_t bytes);
+const struct colorTable *contextColors(struct codecContext *context, 
+                                       int denominator);
+struct cvFrame *contextFrame(struct codecContext *context, unsigned width, 
+                             unsigned height);
+
+/* implemented in compress40.c, which libcomp40.a includes */
+bool contextCompress40(struct codecContext *context, FILE *in, FILE *out);
+bool contextDecompress40(struct codecContext *context, FILE *in, FILE *out);
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Assignment: arith
+ * Name: comp40.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/30/23
+ * Summary: Implements the in-memory interface of libcomp40 on the row codec.
+ *          Compression converts each pair of the caller's scanlines where 
+ *          they lie and packs them straight into the caller's row of words; 
+ *          decompression unpacks each row of words straight into the 
+ *          caller's pair of scanlines. The output is exactly the words (and
+ *          pixels) compress40 and decompress40 produce for the same image.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "comp40.h"
+#include "rowCodec.h"
+#include "ppmIO.h"
+#include "assert.h"
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: comp40Words
+ * Purpose: Get the number of codeWords an image of the given size packs into
+ *          (an odd last row or column of pixels is dropped)
+ * Parameters:
+ *       unsigned width : The width of the image in pixels
+ *      unsigned height : The height of the image in pixels
+ * Output: The number of words, (width / 2) * (height / 2)
+ */
+size_t comp40Words(unsigned width, unsigned height)
+{
+        return (size_t)(width / BLOCK_LENGTH) * (height / BLOCK_LENGTH);
+}
+
+/*
+ * Name: comp40Compress
+ * Purpose: Compress an image in memory into rows of codeWords in memory
+ * Parameters:
+ *      struct codecContext *context : The context to convert in (one per 
+ *                                     thread)
+ *       const unsigned char *pixels : The first scanline of the image, raw 
+ *                                     P6 samples (R G B, one byte each, or 
+ *                                     two big endian bytes each if the 
+ *                                     denominator is over 255)
+ *                     size_t stride : Bytes from one scanline to the next
+ *           unsigned width, height : The size of the image in pixels
+ *                   int denominator : The max val of the samples
+ *                   codeWord *words : Where to put the first row of 
+ *                                     width / 2 words (host order)
+ *                 size_t wordStride : Words from one row of words to the 
+ *                                     next
+ * Output: n/a
+ * Effects: The (height / 2) rows of words are filled
+ * Expectations: The denominator is 1 to 65535 and every buffer is big 
+ *               enough. CRE if the denominator isn't.
+ */
+void comp40Compress(struct codecContext *context, const unsigned char *pixels,
+                    size_t stride, unsigned width, unsigned height, 
+                    int denominator, codeWord *words, size_t wordStride)
+{
+        assert(context != NULL && denominator > 0 && denominator <= 65535);
+        unsigned blockCols = width / BLOCK_LENGTH;
+        unsigned blockRows = height / BLOCK_LENGTH;
+        if (blockCols == 0 || blockRows == 0) {
+                return;
+        }
+
+        struct ppmHeader header = { width, height, denominator, false };
+        const struct colorTable *colors = contextColors(context, denominator);
+        struct cvFrame *frame = contextFrame(context, 
+                                             blockCols * BLOCK_LENGTH, 
+                                             BLOCK_LENGTH);
+
+        const unsigned char *scanlines[BLOCK_LENGTH];
+        for (unsigned row = 0; row < blockRows; ++row) {
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        scanlines[i] = pixels + 
+                                       (row * BLOCK_LENGTH + i) * stride;
+                }
+                packScanlines(scanlines, blockCols, &header, colors, frame, 
+                              words + row * wordStride);
+        }
+}
+
+/*
+ * Name: comp40Decompress
+ * Purpose: Decompress rows of codeWords in memory into an image in memory
+ * Parameters:
+ *      const codeWord *words : The first row of words (host order)
+ *          size_t wordStride : Words from one row of words to the next
+ *         unsigned blockCols : The number of words in a row
+ *         unsigned blockRows : The number of rows of words
+ *      unsigned char *pixels : Where to put the first scanline of the 
+ *                              (2 * blockCols) by (2 * blockRows) image, as
+ *                              one byte R G B samples with a max value of 
+ *                              DENOMINATOR
+ *              size_t stride : Bytes from one scanline to the next
+ * Output: n/a
+ * Effects: The scanlines are filled
+ * Expectations: Every buffer is big enough
+ */
+void comp40Decompress(const codeWord *words, size_t wordStride, 
+                      unsigned blockCols, unsigned blockRows, 
+                      unsigned char *pixels, size_t stride)
+{
+        if (blockCols == 0) {
+                return;
+        }
+
+        unsigned char *scanlines[BLOCK_LENGTH];
+        for (unsigned row = 0; row < blockRows; ++row) {
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        scanlines[i] = pixels + 
+                                       (row * BLOCK_LENGTH + i) * stride;
+                }
+                unpackScanlines(words + row * wordStride, blockCols, 
+                                scanlines);
+        }
+}
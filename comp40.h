@@ -0,0 +1,30 @@
+/*
+ * Assignment: arith
+ * Name: comp40.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/30/23
+ * Summary: The in-memory interface of libcomp40, for embedding the codec in 
+ *          another program. Images go buffer to buffer: rows of raw RGB 
+ *          samples in, rows of host order codeWords out, and back. Every 
+ *          buffer belongs to the caller and is read or written in place 
+ *          through its own stride, so nothing is copied on the way and no 
+ *          file is touched. The codec options of rowCodec.h (useFixedPoint, 
+ *          useTableDecode) apply here too.
+*/
+
+#ifndef COMP40_H_INCLUDED
+#define COMP40_H_INCLUDED
+
+#include <stddef.h>
+#include "codeWord.h"
+#include "codecContext.h"
+
+size_t comp40Words(unsigned width, unsigned height);
+void comp40Compress(struct codecContext *context, const unsigned char *pixels,
+                    size_t stride, unsigned width, unsigned height, 
+                    int denominator, codeWord *words, size_t wordStride);
+void comp40Decompress(const codeWord *words, size_t wordStride, 
+                      unsigned blockCols, unsigned blockRows, 
+                      unsigned char *pixels, size_t stride);
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Assignment: arith
+ * Name: cvFrame.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/28/23
+ * Summary: Allocates and frees planar Component Video frames. The 3 planes 
+ *          share one aligned allocation.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "cvFrame.h"
+#include "mem.h"
+#include "assert.h"
+
+/* floats in FRAME_ALIGN bytes (rows are padded to a multiple of this) */
+static const size_t FLOATS_PER_ALIGN = FRAME_ALIGN / sizeof(float);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: newCvFrame
+ * Purpose: Create a planar frame of the given size
+ * Parameters:
+ *       unsigned width : The number of pixels in each row
+ *      unsigned height : The number of rows
+ * Output: The new frame, whose planes hold unset values
+ * Notes: The frame must be freed with freeCvFrame()
+ */
+struct cvFrame *newCvFrame(unsigned width, unsigned height)
+{
+        struct cvFrame *frame;
+        NEW(frame);
+        frame->width = width;
+        frame->height = height;
+
+        /* pad each row out to a whole number of aligned blocks */
+        frame->stride = (width + FLOATS_PER_ALIGN - 1) / FLOATS_PER_ALIGN * 
+                        FLOATS_PER_ALIGN;
+        if (frame->stride == 0) {
+                frame->stride = FLOATS_PER_ALIGN;
+        }
+        size_t planeFloats = frame->stride * (height > 0 ? height : 1);
+
+        void *planes = NULL;
+        int err = posix_memalign(&planes, FRAME_ALIGN, 
+                                 3 * planeFloats * sizeof(float));
+        assert(err == 0);
+        frame->Y = planes;
+        frame->Pb = frame->Y + planeFloats;
+        frame->Pr = frame->Pb + planeFloats;
+
+        return frame;
+}
+
+/*
+ * Name: freeCvFrame
+ * Purpose: Free the given frame and its planes
+ * Parameters:
+ *      struct cvFrame **frame : A pointer to the frame to free
+ * Output: n/a
+ * Effects: The frame is freed and *frame is set to NULL
+ */
+void freeCvFrame(struct cvFrame **frame)
+{
+        assert(frame != NULL && *frame != NULL);
+        free((*frame)->Y);
+        FREE(*frame);
+}
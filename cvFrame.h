@@ -0,0 +1,35 @@
+/*
+ * Assignment: arith
+ * Name: cvFrame.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/28/23
+ * Summary: Provides a frame of Component Video pixels kept as separate Y, Pb 
+ *          and Pr planes. Every row of every plane starts on a FRAME_ALIGN 
+ *          byte boundary and is padded out to the frame's stride, so the 
+ *          conversion and packing loops stream through contiguous, aligned
+ *          floats.
+*/
+
+#ifndef CVFRAME_H_INCLUDED
+#define CVFRAME_H_INCLUDED
+
+#include <stddef.h>
+
+/* alignment in bytes of the start of every row of a plane */
+#define FRAME_ALIGN 64
+
+/* 
+ * a planar frame of Component Video pixels. Row r of a plane starts at 
+ * plane + r * stride. The fixed point codec keeps int32_t values in the same 
+ * planes.
+ */
+struct cvFrame {
+        unsigned width, height;         /* size in pixels */
+        size_t stride;                  /* floats from one row to the next */
+        float *Y, *Pb, *Pr;
+};
+
+struct cvFrame *newCvFrame(unsigned width, unsigned height);
+void freeCvFrame(struct cvFrame **frame);
+
+#endif
@@ -0,0 +1,85 @@
+/*
+ * Assignment: arith
+ * Name: fixedPoint.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/26/23
+ * Summary: Provides the fixed point format and the integer rounding helpers 
+ *          shared by the integer (-x) version of the codec. Every value is an
+ *          int scaled by 2^FIXED_SHIFT and only integer ops are used, so the 
+ *          integer codec gives the same bits with any compiler or flags.
+ *
+ *          Measured against the float codec:
+ *              - packing the same pixels gives a, b, c and d fields that 
+ *                differ by at most 1. A chroma index only differs when the
+ *                average pb or pr is within 2^-15 of halfway between two 
+ *                chroma levels (gray blocks, whose chroma is exactly 0, are 
+ *                the usual case), and then it is the neighbouring level
+ *              - unpacking the same word gives 8 bit samples that differ by
+ *                at most 1
+ *              - a whole compress and decompress gives the same error 
+ *                against the original image. Samples differ by at most 1 
+ *                except in blocks whose chroma index differs, where they can
+ *                move by up to the gap between neighbouring chroma levels
+ *                (0.15 * 1.772 * 255, about 68)
+*/
+
+#ifndef FIXEDPOINT_H_INCLUDED
+#define FIXEDPOINT_H_INCLUDED
+
+#include <stdint.h>
+
+/* fixed point values are scaled by 2^FIXED_SHIFT (FIXED_ONE is 1.0) */
+#define FIXED_SHIFT 16
+static const int32_t FIXED_ONE = 1 << FIXED_SHIFT;
+
+/*
+ * Name: roundDiv
+ * Purpose: Divide and round to the nearest int, halves away from zero (the 
+ *          same as round() in the float codec)
+ * Parameters:
+ *      int64_t num : The numerator
+ *      int64_t den : The denominator, greater than 0
+ * Output: The rounded quotient
+ */
+static inline int64_t roundDiv(int64_t num, int64_t den)
+{
+        if (num >= 0) {
+                return (num + den / 2) / den;
+        }
+        return -((-num + den / 2) / den);
+}
+
+/*
+ * Name: roundShift
+ * Purpose: Divide by 2^shift and round to the nearest int, halves away from 
+ *          zero, without shifting a negative number
+ * Parameters:
+ *      int64_t num : The number to scale down
+ *        int shift : The power of 2 to divide by, at least 1
+ * Output: The rounded quotient
+ */
+static inline int64_t roundShift(int64_t num, int shift)
+{
+        int64_t half = (int64_t)1 << (shift - 1);
+        if (num >= 0) {
+                return (num + half) >> shift;
+        }
+        return -((-num + half) >> shift);
+}
+
+/*
+ * Name: fixedCoef
+ * Purpose: Turn a conversion constant given in millionths into a fixed point
+ *          coefficient scaled by 2^shift and divided by the given denominator
+ * Parameters:
+ *      int64_t millionths : The constant times 1000000
+ *               int shift : The power of 2 to scale the coefficient by
+ *             int64_t den : The number to divide the coefficient by
+ * Output: round(millionths * 2^shift / (1000000 * den))
+ */
+static inline int64_t fixedCoef(int64_t millionths, int shift, int64_t den)
+{
+        return roundDiv(millionths * ((int64_t)1 << shift), 1000000 * den);
+}
+
+#endif
@@ -10,12 +10,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <pthread.h>
 #include "pack.h"
-#include "bitpack.h"
 #include "codeWord.h"
 #include "packInfo.h"
+#include "wordFields.h"
 #include "quantize.h"
+#include "fixedPoint.h"
 #include "assert.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /* shorten struct names */
 #define quantizedVals struct quantizedVals
@@ -24,11 +29,35 @@
 /* number of pixels to pack */
 const int NUMPIX = 4;
 
+/* number of blocks quantized at a time by packBlocks and unpackBlocks */
+#define PACK_BATCH 64u
+
+/* number of values the a field, a b, c or d field, and both chroma fields 
+   (taken together) can hold */
+#define A_VALUES 512
+#define BCD_VALUES 32
+#define CHROMA_PAIRS 256
+
+/* 
+ * tables for decodeBlocks. The a table holds the dequantized a of every a 
+ * field. The b, c and d tables hold the term each value adds to Y1 to Y4 
+ * (the coefficient with the sign it has in the inverse DCT), and the chroma
+ * table holds the pb and pr of both chroma fields.
+ */
+static float aTerms[A_VALUES];
+static float bTerms[BCD_VALUES][4], cTerms[BCD_VALUES][4], 
+             dTerms[BCD_VALUES][4];
+static float chromaTerms[CHROMA_PAIRS][2];
+static pthread_once_t decodeOnce = PTHREAD_ONCE_INIT;
+
 /* helper functions */
 static void pullOutPixVals(float **pix, pixelVals *pVals);
-static void putInQVals(codeWord *word, quantizedVals *qVals);
-static void pullOutQVals(codeWord word, quantizedVals *qVals);
 static void putInPixVals(float **pix, pixelVals *pVals);
+static struct blockPlanes planesAt(const struct blockPlanes *planes, 
+                                   unsigned first);
+static void buildDecodeTables(void);
+static void decodeWord(codeWord word, const struct blockPlanes *planes, 
+                       unsigned i);
 
 
 /*******************************************************************************
@@ -60,7 +89,7 @@ void packWord(float **pix, codeWord *word)
         quantize(&pVals, &qVals);
 
         /* pack the quanitzed vals in qVals into given word */
-        putInQVals(word, &qVals);
+        *word = packFields(&qVals);
 }
 
 /*
@@ -78,19 +107,222 @@ void packWord(float **pix, codeWord *word)
  */
 void unpackWord(codeWord word, float **pix)
 {
-        /* declare the structs to store pixel vals and quantized vals */
-        quantizedVals qVals;
+        /* unpack the word into the pixel values struct */
         pixelVals pVals;
+        unpackVals(word, &pVals);
+
+        /* put the unquanitzed vals in pVals into given word */
+        putInPixVals(pix, &pVals);
+} 
 
+/*
+ * Name: unpackVals
+ * Purpose: Unpack the given bit packed word into the 4 Y values and the pb 
+ *          and pr shared by its 2 by 2 block, without copying the shared 
+ *          values out to every pixel
+ * Parameters:
+ *         codeWord word : The 32 bit, bit-packed word that is to be 
+ *                         unpacked
+ *      pixelVals *pVals : The struct to store the unpacked values in
+ * Output: n/a
+ * Effects: The given pixelVals struct holds the dequantized values
+ */
+void unpackVals(codeWord word, pixelVals *pVals)
+{
         /* intialize quantized values struct */
-        pullOutQVals(word, &qVals);
+        quantizedVals qVals;
+        unpackFields(word, &qVals);
 
         /* dequantize the pixel values and put them into pix val struct */
-        dequantize(&qVals, &pVals);
+        dequantize(&qVals, pVals);
+}
 
-        /* put the unquanitzed vals in pVals into given word */
-        putInPixVals(pix, &pVals);
-} 
+/*
+ * Name: packBlocks
+ * Purpose: Pack a batch of blocks given as planes into a contiguous array of
+ *          words, giving exactly the words packWord gives for each block
+ * Parameters: 
+ *      const struct blockPlanes *planes : The 4 Y values and the average pb
+ *                                         and pr of each block
+ *                        unsigned count : The number of blocks
+ *                       codeWord *words : The words to pack the blocks into
+ * Output: n/a
+ * Effects: The first count words are filled
+ */
+void packBlocks(const struct blockPlanes *planes, unsigned count, 
+                codeWord *words)
+{
+        int32_t qA[PACK_BATCH], qB[PACK_BATCH], qC[PACK_BATCH], 
+                qD[PACK_BATCH];
+        uint8_t pbChroma[PACK_BATCH], prChroma[PACK_BATCH];
+        struct quantizedPlanes qPlanes = { qA, qB, qC, qD, pbChroma, 
+                                           prChroma };
+        initChroma();
+
+        for (unsigned b = 0; b < count; b += PACK_BATCH) {
+                unsigned n = count - b < PACK_BATCH ? count - b : PACK_BATCH;
+
+                /* quantize a batch of blocks then pack their fields */
+                struct blockPlanes batch = planesAt(planes, b);
+                quantizePlanes(&batch, n, &qPlanes);
+                for (unsigned i = 0; i < n; ++i) {
+                        codeWord word = fieldNewu(0, A_WIDTH, A_LSB, qA[i]);
+                        word = fieldNews(word, B_WIDTH, B_LSB, qB[i]);
+                        word = fieldNews(word, C_WIDTH, C_LSB, qC[i]);
+                        word = fieldNews(word, D_WIDTH, D_LSB, qD[i]);
+                        word = fieldNewu(word, PB_WIDTH, PB_LSB, pbChroma[i]);
+                        word = fieldNewu(word, PR_WIDTH, PR_LSB, prChroma[i]);
+                        words[b + i] = word;
+                }
+        }
+}
+
+/*
+ * Name: unpackBlocks
+ * Purpose: Unpack a contiguous array of words into planes, giving exactly the
+ *          values unpackVals gives for each word
+ * Parameters: 
+ *                 const codeWord *words : The words to unpack
+ *                        unsigned count : The number of words
+ *      const struct blockPlanes *planes : The planes to store the 4 Y values
+ *                                         and the pb and pr of each block in
+ * Output: n/a
+ * Effects: The first count values of every plane are filled
+ */
+void unpackBlocks(const codeWord *words, unsigned count, 
+                  const struct blockPlanes *planes)
+{
+        int32_t qA[PACK_BATCH], qB[PACK_BATCH], qC[PACK_BATCH], 
+                qD[PACK_BATCH];
+        uint8_t pbChroma[PACK_BATCH], prChroma[PACK_BATCH];
+        struct quantizedPlanes qPlanes = { qA, qB, qC, qD, pbChroma, 
+                                           prChroma };
+        initChroma();
+
+        for (unsigned b = 0; b < count; b += PACK_BATCH) {
+                unsigned n = count - b < PACK_BATCH ? count - b : PACK_BATCH;
+
+                /* get the fields of a batch of words then dequantize them */
+                for (unsigned i = 0; i < n; ++i) {
+                        codeWord word = words[b + i];
+                        qA[i] = fieldGetu(word, A_WIDTH, A_LSB);
+                        qB[i] = fieldGets(word, B_WIDTH, B_LSB);
+                        qC[i] = fieldGets(word, C_WIDTH, C_LSB);
+                        qD[i] = fieldGets(word, D_WIDTH, D_LSB);
+                        pbChroma[i] = fieldGetu(word, PB_WIDTH, PB_LSB);
+                        prChroma[i] = fieldGetu(word, PR_WIDTH, PR_LSB);
+                }
+                struct blockPlanes batch = planesAt(planes, b);
+                dequantizePlanes(&qPlanes, n, &batch);
+        }
+}
+
+/*
+ * Name: decodeBlocks
+ * Purpose: Unpack a contiguous array of words into planes with lookup tables
+ *          instead of dequantizing and reversing the DCT. Each Y value is the
+ *          a of its word plus the b, c and d terms, added in the same order
+ *          as the inverse DCT, so the values are exactly the ones 
+ *          unpackBlocks gives. With SSE2 the Y values of 4 words are added 
+ *          at once.
+ * Parameters: 
+ *                 const codeWord *words : The words to unpack
+ *                        unsigned count : The number of words
+ *      const struct blockPlanes *planes : The planes to store the 4 Y values
+ *                                         and the pb and pr of each block in
+ * Output: n/a
+ * Effects: The first count values of every plane are filled
+ */
+void decodeBlocks(const codeWord *words, unsigned count, 
+                  const struct blockPlanes *planes)
+{
+        pthread_once(&decodeOnce, buildDecodeTables);
+        unsigned i = 0;
+
+#if defined(__SSE2__)
+        for (; i + 4 <= count; i += 4) {
+                /* Y1 to Y4 of each of the 4 words */
+                __m128 Y[4];
+                for (int j = 0; j < 4; ++j) {
+                        codeWord word = words[i + j];
+                        Y[j] = _mm_set1_ps(aTerms[fieldGetu(word, A_WIDTH, 
+                                                            A_LSB)]);
+                        Y[j] = _mm_add_ps(Y[j], _mm_loadu_ps(
+                                bTerms[fieldGetu(word, B_WIDTH, B_LSB)]));
+                        Y[j] = _mm_add_ps(Y[j], _mm_loadu_ps(
+                                cTerms[fieldGetu(word, C_WIDTH, C_LSB)]));
+                        Y[j] = _mm_add_ps(Y[j], _mm_loadu_ps(
+                                dTerms[fieldGetu(word, D_WIDTH, D_LSB)]));
+
+                        const float *chroma = chromaTerms[fieldGetu(word, 
+                                PB_WIDTH + PR_WIDTH, PR_LSB)];
+                        planes->pbAvg[i + j] = chroma[0];
+                        planes->prAvg[i + j] = chroma[1];
+                }
+
+                /* regroup them into a plane for each Y */
+                _MM_TRANSPOSE4_PS(Y[0], Y[1], Y[2], Y[3]);
+                _mm_storeu_ps(planes->Y1 + i, Y[0]);
+                _mm_storeu_ps(planes->Y2 + i, Y[1]);
+                _mm_storeu_ps(planes->Y3 + i, Y[2]);
+                _mm_storeu_ps(planes->Y4 + i, Y[3]);
+        }
+#endif
+
+        for (; i < count; ++i) {
+                decodeWord(words[i], planes, i);
+        }
+}
+
+
+/*
+ * Name: packWordFixed
+ * Purpose: Pack the given array of 4 fixed point pixels into the given 32 bit
+ *          word using only integer math
+ * Parameters: 
+ *       int32_t **pix : An array of pointers to the Y, pb and pr values 
+ *                       (scaled by 2^FIXED_SHIFT) of the 4 pixels to pack
+ *      codeWord *word : A pointer to the a 32 bit word to pack the compressed 
+ *                       pixels into
+ * Output: n/a
+ * Effects: Pixel data is compressed into the word passed in by caller
+ */
+void packWordFixed(int32_t **pix, codeWord *word)
+{
+        /* get the 4 Y vals and the rounded average pb and pr */
+        struct fixedVals fVals;
+        fVals.Y1 = pix[0][0];
+        fVals.Y2 = pix[1][0];
+        fVals.Y3 = pix[2][0];
+        fVals.Y4 = pix[3][0];
+        fVals.pbAvg = roundShift((int64_t)pix[0][1] + pix[1][1] + pix[2][1] + 
+                                 pix[3][1], 2);
+        fVals.prAvg = roundShift((int64_t)pix[0][2] + pix[1][2] + pix[2][2] + 
+                                 pix[3][2], 2);
+
+        /* quantize the pixel values and pack them into the word */
+        quantizedVals qVals;
+        quantizeFixed(&fVals, &qVals);
+        *word = packFields(&qVals);
+}
+
+/*
+ * Name: unpackValsFixed
+ * Purpose: Unpack the given bit packed word into the fixed point Y values and
+ *          the pb and pr shared by its 2 by 2 block using only integer math
+ * Parameters:
+ *         codeWord word : The 32 bit, bit-packed word that is to be 
+ *                         unpacked
+ *      fixedVals *fVals : The struct to store the unpacked values in
+ * Output: n/a
+ * Effects: The given fixedVals struct holds the dequantized values
+ */
+void unpackValsFixed(codeWord word, struct fixedVals *fVals)
+{
+        quantizedVals qVals;
+        unpackFields(word, &qVals);
+        dequantizeFixed(&qVals, fVals);
+}
 
 
 /*******************************************************************************
@@ -123,55 +355,11 @@ void pullOutPixVals(float **pix, pixelVals *pVals)
         pVals->prAvg = (pix[0][2] + pix[1][2] + pix[2][2] + pix[3][2]) / NUMPIX;
 }
 
-/*
- * Name: putInQVals
- * Purpose: Pack the quantized values in the quantizedVals struct into the 
- *          given word 
- * Parameters: 
- *            code *word : A pointer to the word that will store the packed 
- *                             quantized pixel data.
- *      quantizedVals *qVals : A pointer to a struct that stores the quantized 
- *                             values of each DCT coefficent
- * Output: n/a
- * Effects: The word is fully packed witht the quantized data
- */
-void putInQVals(codeWord *word, quantizedVals *qVals)
-{
-        *word = Bitpack_newu(*word, A_WIDTH, A_LSB, qVals->qA);
-        *word = Bitpack_news(*word, B_WIDTH, B_LSB, qVals->qB);
-        *word = Bitpack_news(*word, C_WIDTH, C_LSB, qVals->qC);
-        *word = Bitpack_news(*word, D_WIDTH, D_LSB, qVals->qD);
-        *word = Bitpack_newu(*word, PB_WIDTH, PB_LSB, qVals->pbChroma);
-        *word = Bitpack_newu(*word, PR_WIDTH, PR_LSB, qVals->prChroma);
-}
-
       
 /*******************************************************************************
 *                        unpackWord Helper Functions                           *
 *******************************************************************************/
 
-/*
- * Name: pullOutQVals
- * Purpose: Initialzes the given quantizedVal struct using given word
- * Parameters: 
- *             codeWord word : The word that contians the packed quantized 
- *                             pixel data
- *      quantizedVals *qVals : A pointer to a struct that stores the quantized 
- *                             values
- * Output: n/a
- * Effects: The given quantizedVal struct is initialized to hold the 
- *          information stored in the given bit packed word.
- */
-void pullOutQVals(codeWord word, quantizedVals *qVals)
-{
-        qVals->qA = Bitpack_getu(word, A_WIDTH, A_LSB);
-        qVals->qB = Bitpack_gets(word, B_WIDTH, B_LSB);
-        qVals->qC = Bitpack_gets(word, C_WIDTH, C_LSB);
-        qVals->qD = Bitpack_gets(word, D_WIDTH, D_LSB);
-        qVals->pbChroma = Bitpack_getu(word, PB_WIDTH, PB_LSB);
-        qVals->prChroma = Bitpack_getu(word, PR_WIDTH, PR_LSB);
-}
-
 /*
  * Name: putInPixVals
  * Purpose: Put the unpacked pixel data in the pixelVals struct into the 
@@ -197,5 +385,107 @@ void putInPixVals(float **pix, pixelVals *pVals)
         pix[0][2] = pix[1][2] = pix[2][2] = pix[3][2] = pVals->prAvg;
 }
 
+
+/*******************************************************************************
+*                        Batched (Planar) Helper Functions                     *
+*******************************************************************************/
+
+/*
+ * Name: planesAt
+ * Purpose: Get the planes of a batch of blocks starting part way into the 
+ *          given planes
+ * Parameters: 
+ *      const struct blockPlanes *planes : The planes of every block
+ *                        unsigned first : The block the new planes start at
+ * Output: The planes starting at the first block
+ */
+struct blockPlanes planesAt(const struct blockPlanes *planes, unsigned first)
+{
+        struct blockPlanes batch = { planes->Y1 + first, planes->Y2 + first,
+                                     planes->Y3 + first, planes->Y4 + first,
+                                     planes->pbAvg + first, 
+                                     planes->prAvg + first };
+        return batch;
+}
+
+/*
+ * Name: decodeWord
+ * Purpose: Unpack one word into the planes with the decode tables
+ * Parameters: 
+ *                         codeWord word : The word to unpack
+ *      const struct blockPlanes *planes : The planes to store the values in
+ *                            unsigned i : The index of the block
+ * Output: n/a
+ */
+void decodeWord(codeWord word, const struct blockPlanes *planes, unsigned i)
+{
+        float a = aTerms[fieldGetu(word, A_WIDTH, A_LSB)];
+        const float *b = bTerms[fieldGetu(word, B_WIDTH, B_LSB)];
+        const float *c = cTerms[fieldGetu(word, C_WIDTH, C_LSB)];
+        const float *d = dTerms[fieldGetu(word, D_WIDTH, D_LSB)];
+        planes->Y1[i] = ((a + b[0]) + c[0]) + d[0];
+        planes->Y2[i] = ((a + b[1]) + c[1]) + d[1];
+        planes->Y3[i] = ((a + b[2]) + c[2]) + d[2];
+        planes->Y4[i] = ((a + b[3]) + c[3]) + d[3];
+
+        const float *chroma = chromaTerms[fieldGetu(word, PB_WIDTH + PR_WIDTH,
+                                                    PR_LSB)];
+        planes->pbAvg[i] = chroma[0];
+        planes->prAvg[i] = chroma[1];
+}
+
+/*
+ * Name: buildDecodeTables
+ * Purpose: Fill the decode tables by dequantizing every value of each field
+ *          on its own (with the other coefficients 0), so they hold exactly
+ *          what dequantize works out
+ * Parameters: n/a
+ * Output: n/a
+ * Effects: The decode tables are filled
+ * Expectations: The field widths match the table sizes and pb sits just above
+ *               pr. CRE if not.
+ */
+void buildDecodeTables(void)
+{
+        assert(A_VALUES == 1 << A_WIDTH && BCD_VALUES == 1 << B_WIDTH);
+        assert(B_WIDTH == C_WIDTH && C_WIDTH == D_WIDTH);
+        assert(CHROMA_PAIRS == 1 << (PB_WIDTH + PR_WIDTH));
+        assert(PB_LSB == PR_LSB + PR_WIDTH);
+        initChroma();
+
+        pixelVals pVals;
+        for (int v = 0; v < A_VALUES; ++v) {
+                quantizedVals qVals = { v, 0, 0, 0, 0, 0 };
+                dequantize(&qVals, &pVals);
+                aTerms[v] = pVals.Y1;
+        }
+
+        for (int v = 0; v < BCD_VALUES; ++v) {
+                codeWord field = v;
+                int64_t coef = fieldGets(field, B_WIDTH, 0);
+                quantizedVals qVals[3] = { { 0, coef, 0, 0, 0, 0 },
+                                           { 0, 0, coef, 0, 0, 0 },
+                                           { 0, 0, 0, coef, 0, 0 } };
+                float (*terms[3])[4] = { bTerms, cTerms, dTerms };
+                for (int i = 0; i < 3; ++i) {
+                        dequantize(&qVals[i], &pVals);
+                        terms[i][v][0] = pVals.Y1;
+                        terms[i][v][1] = pVals.Y2;
+                        terms[i][v][2] = pVals.Y3;
+                        terms[i][v][3] = pVals.Y4;
+                }
+        }
+
+        for (int v = 0; v < CHROMA_PAIRS; ++v) {
+                codeWord fields = v;
+                quantizedVals qVals = { 0, 0, 0, 0, 
+                        fieldGetu(fields, PB_WIDTH, PR_WIDTH), 
+                        fieldGetu(fields, PR_WIDTH, 0) };
+                dequantize(&qVals, &pVals);
+                chromaTerms[v][0] = pVals.pbAvg;
+                chromaTerms[v][1] = pVals.prAvg;
+        }
+}
+
 #undef quantizedVals
 #undef pixelVals
@@ -5,15 +5,27 @@
  * Date: 10/18/23
  * Summary: Provides function declarations for a function that packs 4 given 
  *          pixels into a given codeWord and one that  unpacks a given codeWord 
- *          into 4 given pixels.
+ *          into 4 given pixels, and functions that pack or unpack a whole 
+ *          batch of blocks given as planes (unpacking either by 
+ *          dequantizing or with lookup tables).
 */
 
 #ifndef PACK_H_INCLUDED
 #define PACK_H_INCLUDED
 
 #include "codeWord.h"
+#include "packInfo.h"
 
 void packWord(float **pix, codeWord *word);
 void unpackWord(codeWord word, float **pix);
+void unpackVals(codeWord word, struct pixelVals *pVals);
+void packBlocks(const struct blockPlanes *planes, unsigned count, 
+                codeWord *words);
+void unpackBlocks(const codeWord *words, unsigned count, 
+                  const struct blockPlanes *planes);
+void decodeBlocks(const codeWord *words, unsigned count, 
+                  const struct blockPlanes *planes);
+void packWordFixed(int32_t **pix, codeWord *word);
+void unpackValsFixed(codeWord word, struct fixedVals *fVals);
 
 #endif
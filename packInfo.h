@@ -4,8 +4,9 @@
  * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
  * Date: 10/19/23
  * Summary: Provides the width and locations of the quantized components in the 
- *          codeWord as well as two structs to hold quantized and dequantized 
- *          pixel values.
+ *          codeWord as well as structs to hold quantized and dequantized 
+ *          (float or fixed point) pixel values, one block at a time or as 
+ *          planes for a batch of blocks.
 */
 
 #ifndef PACKINFO_H_INCLUDED
@@ -37,4 +38,25 @@ struct pixelVals {
         float pbAvg, prAvg;
 };
 
+/* 
+ * a batch of blocks as planes, one array of floats per value. Y1 to Y4 are 
+ * the top left, top right, bottom left and bottom right pixels.
+ */
+struct blockPlanes {
+        float *Y1, *Y2, *Y3, *Y4;
+        float *pbAvg, *prAvg;
+};
+
+/* a batch of quantized blocks as planes, one array per field */
+struct quantizedPlanes {
+        int32_t *qA, *qB, *qC, *qD;
+        uint8_t *pbChroma, *prChroma;
+};
+
+/* struct to hold the fixed point (2^FIXED_SHIFT) pixel values for -x */
+struct fixedVals {
+        int32_t Y1, Y2, Y3, Y4;
+        int32_t pbAvg, prAvg;
+};
+
 #endif
@@ -0,0 +1,472 @@
+/*
+ * Assignment: arith
+ * Name: parallel40.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/23/23
+ * Summary: Compresses or decompresses a ppm file on a pool of threads. Every 
+ *          2 by 2 block is independent, so the rows of blocks are handed out 
+ *          in bands to the threads. When compressing, the threads pack the 
+ *          shared array of words, which is printed once every band is done. 
+ *          When decompressing, each band's words sit at an offset known from 
+ *          the header, so the threads unpack bands into scanlines that are 
+ *          printed in order as soon as they are ready. Either way the output 
+ *          is identical to the serial version.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "parallel40.h"
+#include "codeWord.h"
+#include "ppmIO.h"
+#include "rowCodec.h"
+#include "wordIO.h"
+#include "RGBcompvConvert.h"
+#include "cvFrame.h"
+#include "a2methods.h"
+#include "a2plain.h"
+#include "mem.h"
+#include "assert.h"
+
+/* used to help simplify the syntax */
+typedef A2Methods_UArray2 A2;
+#define Pmethods uarray2_methods_plain
+#define Object A2Methods_Object
+
+/* number of rows of blocks handed to a thread at a time */
+static const int BAND_ROWS = 16;
+
+/* the work shared between the threads while compressing */
+struct bandWork {
+        struct ppmRaster *image;
+        struct colorTable *colors;
+        A2 packed;
+        int nextRow;
+        pthread_mutex_t lock;
+};
+
+/* a decompressed band waiting to be printed */
+struct decodedBand {
+        unsigned char *raster;
+        size_t bytes;
+        bool done;
+};
+
+/* the work shared between the threads while decompressing */
+struct decodeWork {
+        int fd;                       /* compressed file if it is seekable */
+        off_t payload;                /* offset of the first word in fd */
+        unsigned char *words;         /* the whole payload if not seekable */
+        bool swap;                    /* words aren't in host order */
+        struct ppmHeader header;
+        unsigned blockCols, blockRows;
+        int bands, nextBand, written;
+        int window;                   /* max bands decoded ahead of printing */
+        struct decodedBand *slots;    /* window many slots, reused in turn */
+        pthread_mutex_t lock;
+        pthread_cond_t changed;
+};
+
+/* helper funcs */
+static void *compressBands(void *work);
+static int takeBand(struct bandWork *work);
+static void packBlockRow(struct bandWork *work, int row, 
+                         struct cvFrame *frame);
+static void *decompressBands(void *work);
+static int takeDecodeBand(struct decodeWork *work);
+static void finishBand(struct decodeWork *work, int band);
+static void readBandWords(struct decodeWork *work, int first, int rows,
+                          codeWord *words);
+static void decodeBand(struct decodeWork *work, int band, codeWord *words);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: parallelCompress40
+ * Purpose: Compress each 2 by 2 block of pixels in the given ppm into 32 bit
+ *          words using the given number of threads and print the compressed
+ *          image to stdout.
+ * Parameters:
+ *              FILE *fp : file pointer that contains the ppm file to compress
+ *      unsigned threads : The number of threads to pack the image with
+ * Output: n/a
+ * Effects: The compressed file is printed to stdout exactly as compress40
+ *          would print it.
+ * Expectations: threads is at least 1. CRE if not.
+ */
+void parallelCompress40(FILE *fp, unsigned threads)
+{
+        assert(threads >= 1);
+
+        /* map (or read in) the raw samples of the file */
+        struct ppmRaster image;
+        readPpmRaster(fp, &image);
+
+        /* create uarray to hold packed words (omits odd width/height) */
+        int width = image.header.width / BLOCK_LENGTH;
+        int height = image.header.height / BLOCK_LENGTH;
+        A2 packed = Pmethods->new(width, height, sizeof(codeWord));
+
+        /* convert and pack the bands on the pool of threads */
+        struct bandWork work = { &image, 
+                                 newColorTable(image.header.denominator),
+                                 packed, 0, PTHREAD_MUTEX_INITIALIZER };
+        pthread_t *pool = ALLOC(threads * sizeof(pthread_t));
+        for (unsigned i = 0; i < threads; ++i) {
+                int err = pthread_create(&pool[i], NULL, compressBands, &work);
+                assert(err == 0);
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+                pthread_join(pool[i], NULL);
+        }
+
+        /* write pixelmap to stdout */
+        writeWordHeader(stdout, width * BLOCK_LENGTH, height * BLOCK_LENGTH);
+        printWordArray(packed, Pmethods);
+
+        /* free the pool, the color table, the packed array and the raster */
+        FREE(pool);
+        pthread_mutex_destroy(&work.lock);
+        freeColorTable(&work.colors);
+        freePpmRaster(&image);
+        Pmethods->free(&packed);
+}
+
+/*
+ * Name: parallelDecompress40
+ * Purpose: Decompress the given file (32 bit words -> pixels) using the given
+ *          number of threads and print out the decompressed ppm image to
+ *          stdout
+ * Parameters:
+ *              FILE *fp : A file pointer to the compressed ppm file
+ *      unsigned threads : The number of threads to unpack the image with
+ * Output: The decompressed file is written to stdout as a P6 ppm file exactly
+ *         as decompress40 would write it.
+ * Expectations: threads is at least 1 and the given file pointer is 
+ *               formatted correctly. CRE if not.
+ */
+void parallelDecompress40(FILE *fp, unsigned threads)
+{
+        assert(threads >= 1);
+
+        /* read in header and print the ppm header */
+        struct decodeWork work;
+        unsigned width, height;
+        work.swap = readWordHeader(fp, &width, &height);
+        work.blockCols = width / BLOCK_LENGTH;
+        work.blockRows = height / BLOCK_LENGTH;
+        work.header.width = work.blockCols * BLOCK_LENGTH;
+        work.header.height = work.blockRows * BLOCK_LENGTH;
+        work.header.denominator = DENOMINATOR;
+        work.header.plain = false;
+        writePpmHeader(stdout, &work.header);
+        if (work.blockCols == 0 || work.blockRows == 0) {
+                return;
+        }
+
+        /* threads read a seekable file at their band's offset themselves */
+        size_t payloadBytes = (size_t)work.blockCols * work.blockRows * 
+                              sizeof(codeWord);
+        struct stat info;
+        work.fd = fileno(fp);
+        work.payload = ftello(fp);
+        work.words = NULL;
+        if (fstat(work.fd, &info) != 0 || !S_ISREG(info.st_mode) || 
+            work.payload < 0) {
+                work.words = ALLOC(payloadBytes);
+                size_t read = fread(work.words, 1, payloadBytes, fp);
+                assert(read == payloadBytes);
+        } else {
+                assert((size_t)(info.st_size - work.payload) >= payloadBytes);
+        }
+
+        /* set up the window of bands that may be decoded ahead of printing */
+        size_t bandBytes = (size_t)BAND_ROWS * BLOCK_LENGTH * 
+                           work.header.width * PIXEL_VALS;
+        work.bands = (work.blockRows + BAND_ROWS - 1) / BAND_ROWS;
+        work.nextBand = work.written = 0;
+        work.window = 2 * threads;
+        work.slots = ALLOC(work.window * sizeof(struct decodedBand));
+        for (int i = 0; i < work.window; ++i) {
+                work.slots[i].raster = ALLOC(bandBytes);
+                work.slots[i].done = false;
+        }
+        pthread_mutex_init(&work.lock, NULL);
+        pthread_cond_init(&work.changed, NULL);
+
+        /* unpack the bands on the pool of threads */
+        pthread_t *pool = ALLOC(threads * sizeof(pthread_t));
+        for (unsigned i = 0; i < threads; ++i) {
+                int err = pthread_create(&pool[i], NULL, decompressBands, 
+                                         &work);
+                assert(err == 0);
+        }
+
+        /* print the bands in order as they finish */
+        for (int band = 0; band < work.bands; ++band) {
+                struct decodedBand *slot = &work.slots[band % work.window];
+                pthread_mutex_lock(&work.lock);
+                while (!slot->done) {
+                        pthread_cond_wait(&work.changed, &work.lock);
+                }
+                pthread_mutex_unlock(&work.lock);
+
+                fwrite(slot->raster, 1, slot->bytes, stdout);
+
+                pthread_mutex_lock(&work.lock);
+                slot->done = false;
+                work.written++;
+                pthread_cond_broadcast(&work.changed);
+                pthread_mutex_unlock(&work.lock);
+        }
+        for (unsigned i = 0; i < threads; ++i) {
+                pthread_join(pool[i], NULL);
+        }
+
+        /* free the pool and the bands */
+        FREE(pool);
+        for (int i = 0; i < work.window; ++i) {
+                FREE(work.slots[i].raster);
+        }
+        FREE(work.slots);
+        if (work.words != NULL) {
+                FREE(work.words);
+        }
+        pthread_mutex_destroy(&work.lock);
+        pthread_cond_destroy(&work.changed);
+}
+
+
+/*******************************************************************************
+*                        Compression Helper Functions                          *
+*******************************************************************************/
+
+/*
+ * Name: compressBands
+ * Purpose: Run by each thread in the pool. Takes bands of block rows until
+ *          there are none left and packs every block in them.
+ * Parameters:
+ *      void *work : The bandWork shared by every thread
+ * Output: NULL
+ * Effects: The words of every band taken are filled in the packed array
+ */
+void *compressBands(void *work)
+{
+        struct bandWork *bands = work;
+        int width = Pmethods->width(bands->packed);
+        int height = Pmethods->height(bands->packed);
+
+        /* scratch frame to convert one row of blocks */
+        struct cvFrame *frame = newCvFrame(width * BLOCK_LENGTH, 
+                                           BLOCK_LENGTH);
+
+        int first;
+        while ((first = takeBand(bands)) < height) {
+                int last = first + BAND_ROWS < height ? first + BAND_ROWS
+                                                      : height;
+                for (int row = first; row < last; ++row) {
+                        packBlockRow(bands, row, frame);
+                }
+        }
+
+        freeCvFrame(&frame);
+        return NULL;
+}
+
+/*
+ * Name: takeBand
+ * Purpose: Hand out the next band of block rows to the calling thread
+ * Parameters:
+ *      struct bandWork *work : The work shared by every thread
+ * Output: The first block row of the band (past the last row when done)
+ */
+int takeBand(struct bandWork *work)
+{
+        pthread_mutex_lock(&work->lock);
+        int first = work->nextRow;
+        work->nextRow += BAND_ROWS;
+        pthread_mutex_unlock(&work->lock);
+
+        return first;
+}
+
+/*
+ * Name: packBlockRow
+ * Purpose: Convert the pixels of every 2 by 2 block in the given row of
+ *          blocks to component video and pack them into the packed array
+ * Parameters:
+ *      struct bandWork *work : The raster and packed array being worked on
+ *                    int row : The row of blocks to pack
+ *      struct cvFrame *frame : The thread's scratch frame to convert into
+ * Output: n/a
+ * Effects: The row of the packed array is filled. The raster is only read, 
+ *          and each thread writes only the words of its own rows.
+ */
+void packBlockRow(struct bandWork *work, int row, struct cvFrame *frame)
+{
+        int width = Pmethods->width(work->packed);
+        if (width == 0) {
+                return;
+        }
+
+        /* get the pair of scanlines holding the row of blocks */
+        const unsigned char *scanlines[BLOCK_LENGTH];
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                scanlines[i] = rasterRow(work->image, row * BLOCK_LENGTH + i);
+        }
+
+        /* convert and pack the row of blocks into its (contiguous) words */
+        packScanlines(scanlines, width, &work->image->header, work->colors, 
+                      frame, Pmethods->at(work->packed, 0, row));
+}
+
+
+
+/*******************************************************************************
+*                        Decompression Helper Functions                        *
+*******************************************************************************/
+
+/*
+ * Name: decompressBands
+ * Purpose: Run by each thread in the pool. Takes bands of block rows until
+ *          there are none left and unpacks each into its slot.
+ * Parameters:
+ *      void *work : The decodeWork shared by every thread
+ * Output: NULL
+ * Effects: The slot of every band taken holds its scanlines and is marked 
+ *          done
+ */
+void *decompressBands(void *work)
+{
+        struct decodeWork *bands = work;
+
+        /* scratch space for one band of words */
+        codeWord *words = ALLOC(BAND_ROWS * bands->blockCols * 
+                                sizeof(codeWord));
+
+        int band;
+        while ((band = takeDecodeBand(bands)) < bands->bands) {
+                decodeBand(bands, band, words);
+                finishBand(bands, band);
+        }
+
+        FREE(words);
+        return NULL;
+}
+
+/*
+ * Name: takeDecodeBand
+ * Purpose: Hand out the next band to the calling thread, waiting until its 
+ *          slot has been printed if the thread is too far ahead
+ * Parameters:
+ *      struct decodeWork *work : The work shared by every thread
+ * Output: The band to decode (past the last band when done)
+ */
+int takeDecodeBand(struct decodeWork *work)
+{
+        pthread_mutex_lock(&work->lock);
+        while (work->nextBand < work->bands && 
+               work->nextBand >= work->written + work->window) {
+                pthread_cond_wait(&work->changed, &work->lock);
+        }
+        int band = work->nextBand;
+        if (band < work->bands) {
+                work->nextBand++;
+        }
+        pthread_mutex_unlock(&work->lock);
+
+        return band;
+}
+
+/*
+ * Name: finishBand
+ * Purpose: Mark the given band as ready to print
+ * Parameters:
+ *      struct decodeWork *work : The work shared by every thread
+ *                     int band : The band that was decoded
+ * Output: n/a
+ */
+void finishBand(struct decodeWork *work, int band)
+{
+        pthread_mutex_lock(&work->lock);
+        work->slots[band % work->window].done = true;
+        pthread_cond_broadcast(&work->changed);
+        pthread_mutex_unlock(&work->lock);
+}
+
+/*
+ * Name: readBandWords
+ * Purpose: Get the words of the given rows of blocks in host order
+ * Parameters:
+ *      struct decodeWork *work : The work shared by every thread
+ *                    int first : The first row of blocks to get
+ *                     int rows : The number of rows of blocks to get
+ *              codeWord *words : Where to put the words
+ * Output: n/a
+ * Expectations: The compressed file holds every word. CRE if not.
+ */
+void readBandWords(struct decodeWork *work, int first, int rows, 
+                   codeWord *words)
+{
+        size_t offset = (size_t)first * work->blockCols * sizeof(codeWord);
+        size_t bytes = (size_t)rows * work->blockCols * sizeof(codeWord);
+
+        if (work->words != NULL) {
+                wordsToHost(work->words + offset, words, 
+                            bytes / sizeof(codeWord), work->swap);
+                return;
+        }
+
+        /* pread doesn't move the file position, so threads can share fd */
+        unsigned char *raw = (unsigned char *)words;
+        size_t got = 0;
+        while (got < bytes) {
+                ssize_t read = pread(work->fd, raw + got, bytes - got, 
+                                     work->payload + offset + got);
+                assert(read > 0);
+                got += read;
+        }
+        wordsToHost(raw, words, bytes / sizeof(codeWord), work->swap);
+}
+
+/*
+ * Name: decodeBand
+ * Purpose: Unpack and convert every row of blocks in the given band into the 
+ *          raw P6 scanlines of its slot
+ * Parameters:
+ *      struct decodeWork *work : The work shared by every thread
+ *                     int band : The band to decode
+ *              codeWord *words : Scratch words for one band
+ * Output: n/a
+ * Effects: The band's slot holds its scanlines and their size in bytes
+ */
+void decodeBand(struct decodeWork *work, int band, codeWord *words)
+{
+        int first = band * BAND_ROWS;
+        int count = (int)work->blockRows - first < BAND_ROWS ? 
+                    (int)work->blockRows - first : BAND_ROWS;
+        readBandWords(work, first, count, words);
+
+        struct decodedBand *slot = &work->slots[band % work->window];
+        size_t rowBytes = (size_t)work->header.width * PIXEL_VALS;
+        for (int r = 0; r < count; ++r) {
+                unsigned char *rows[BLOCK_LENGTH];
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        rows[i] = slot->raster + 
+                                  (r * BLOCK_LENGTH + i) * rowBytes;
+                }
+                unpackScanlines(words + r * work->blockCols, work->blockCols, 
+                                rows);
+        }
+        slot->bytes = count * BLOCK_LENGTH * rowBytes;
+}
+
+#undef Pmethods
+#undef Object
@@ -0,0 +1,19 @@
+/*
+ * Assignment: arith
+ * Name: parallel40.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/23/23
+ * Summary: Provides multithreaded versions of compress40 and decompress40 
+ *          that split the image into horizontal bands of 2 by 2 blocks and 
+ *          pack/unpack the bands on a pool of threads.
+*/
+
+#ifndef PARALLEL40_H_INCLUDED
+#define PARALLEL40_H_INCLUDED
+
+#include <stdio.h>
+
+void parallelCompress40(FILE *fp, unsigned threads);
+void parallelDecompress40(FILE *fp, unsigned threads);
+
+#endif
@@ -0,0 +1,468 @@
+/*
+ * Assignment: arith
+ * Name: pipeline40.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/31/23
+ * Summary: Compresses or decompresses a ppm file as a three stage pipeline.
+ *          A reader thread reads bands of rows of blocks, converting threads
+ *          pack or unpack them, and the calling thread writes them out in
+ *          order. Each converting thread has a lane: a fixed set of band
+ *          buffers that go round three single producer, single consumer
+ *          rings (reader to converter, converter to writer, and writer back
+ *          to reader). Bands are dealt to the lanes in turn, so the writer
+ *          always knows which lane the next band comes from and the output
+ *          is identical to the serial version. The input is read as a stream
+ *          like stream40, so it may be a pipe or a slow mount.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include "pipeline40.h"
+#include "codeWord.h"
+#include "ppmIO.h"
+#include "rowCodec.h"
+#include "wordIO.h"
+#include "RGBcompvConvert.h"
+#include "cvFrame.h"
+#include "spscRing.h"
+#include "mem.h"
+#include "assert.h"
+
+/* number of rows of blocks in a band */
+static const unsigned BAND_ROWS = 16;
+
+/* bands owned by each lane, the most it has in flight (a power of 2) */
+#define LANE_BANDS 4
+
+/* 
+ * a band of rows of blocks as scanlines and as words, sharing one buffer:
+ * compressing puts the words first and the scanlines a row of words later, 
+ * decompressing puts the words a row of words past the scanlines, so 
+ * converting a row of blocks only ever overwrites rows already converted
+ */
+struct band {
+        unsigned first, rows;         /* the rows of blocks it covers */
+        unsigned char *buffer;        /* the band's only allocation */
+        unsigned char *pixels;        /* rows * 2 scanlines of raw samples */
+        codeWord *words;              /* rows rows of words, host order */
+};
+
+struct pipeline;
+
+/* one converting thread, its bands and the rings they travel around */
+struct lane {
+        struct pipeline *pipe;
+        unsigned id;
+        struct band bands[LANE_BANDS];
+        struct spscRing *empty;       /* written out, back to the reader */
+        struct spscRing *full;        /* read in, on to the converter */
+        struct spscRing *done;        /* converted, on to the writer */
+        struct cvFrame *frame;        /* compressing only */
+};
+
+/* the image and the stages working on it */
+struct pipeline {
+        FILE *in;
+        struct ppmHeader header;      /* of the image read or written */
+        bool swap;                    /* words read aren't in host order */
+        unsigned blockCols, blockRows;
+        unsigned bands, lanes;
+        size_t rowBytes;              /* raw bytes in one scanline */
+        struct colorTable *colors;    /* compressing only */
+        struct wordWriter *writer;    /* compressing only */
+        struct lane *lane;            /* lanes many */
+        void (*read)(struct pipeline *pipe, struct band *band);
+        void (*convert)(struct lane *lane, struct band *band);
+        void (*write)(struct pipeline *pipe, struct band *band);
+};
+
+/* helper funcs */
+static void setUpPipeline(struct pipeline *pipe, FILE *in, unsigned threads,
+                          size_t rowBytes, bool compress);
+static void runPipeline(struct pipeline *pipe);
+static void tearDownPipeline(struct pipeline *pipe);
+static void *readBands(void *pipe);
+static void *convertBands(void *lane);
+static void bandScanlines(struct pipeline *pipe, struct band *band,
+                          unsigned row, unsigned char **scanlines);
+static void readScanlines(struct pipeline *pipe, struct band *band);
+static void packBand(struct lane *lane, struct band *band);
+static void printWords(struct pipeline *pipe, struct band *band);
+static void readBandWords(struct pipeline *pipe, struct band *band);
+static void unpackBand(struct lane *lane, struct band *band);
+static void printScanlines(struct pipeline *pipe, struct band *band);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: pipelineCompress40
+ * Purpose: Compress each 2 by 2 block of pixels in the given ppm into 32 bit
+ *          words and print the compressed image to stdout, reading, packing
+ *          and printing bands of the image at the same time
+ * Parameters:
+ *              FILE *fp : file pointer that contains the ppm file to compress
+ *      unsigned threads : The number of threads packing bands
+ * Output: n/a
+ * Effects: The compressed file is printed to stdout exactly as compress40
+ *          would print it.
+ * Expectations: threads is at least 1 and fp holds a P6 or P3 ppm file. CRE
+ *               if not.
+ */
+void pipelineCompress40(FILE *fp, unsigned threads)
+{
+        /* read in only the header of the image */
+        struct pipeline pipe;
+        readPpmHeader(fp, &pipe.header);
+
+        /* print the header (omits odd width/height) */
+        pipe.blockCols = pipe.header.width / BLOCK_LENGTH;
+        pipe.blockRows = pipe.header.height / BLOCK_LENGTH;
+        writeWordHeader(stdout, pipe.blockCols * BLOCK_LENGTH,
+                        pipe.blockRows * BLOCK_LENGTH);
+        if (pipe.blockCols == 0 || pipe.blockRows == 0) {
+                return;
+        }
+
+        /* each lane converts a pair of scanlines at a time in its frame */
+        setUpPipeline(&pipe, fp, threads, (size_t)pipe.header.width *
+                      PIXEL_VALS * ppmSampleBytes(&pipe.header), true);
+        pipe.colors = newColorTable(pipe.header.denominator);
+        pipe.writer = newWordWriter(stdout);
+        for (unsigned i = 0; i < pipe.lanes; ++i) {
+                pipe.lane[i].frame = newCvFrame(pipe.blockCols *
+                                                BLOCK_LENGTH, BLOCK_LENGTH);
+        }
+        pipe.read = readScanlines;
+        pipe.convert = packBand;
+        pipe.write = printWords;
+        runPipeline(&pipe);
+
+        /* flush the writer and free the frames and color table */
+        freeWordWriter(&pipe.writer);
+        for (unsigned i = 0; i < pipe.lanes; ++i) {
+                freeCvFrame(&pipe.lane[i].frame);
+        }
+        freeColorTable(&pipe.colors);
+        tearDownPipeline(&pipe);
+}
+
+/*
+ * Name: pipelineDecompress40
+ * Purpose: Decompress the given file (32 bit words -> pixels) and print out
+ *          the decompressed ppm image to stdout, reading, unpacking and
+ *          printing bands of the image at the same time
+ * Parameters:
+ *              FILE *fp : A file pointer to the compressed ppm file
+ *      unsigned threads : The number of threads unpacking bands
+ * Output: The decompressed file is written to stdout as a P6 ppm file exactly
+ *         as decompress40 would write it.
+ * Expectations: threads is at least 1 and the given file pointer is
+ *               formatted correctly. CRE if not.
+ */
+void pipelineDecompress40(FILE *fp, unsigned threads)
+{
+        /* read in header */
+        struct pipeline pipe;
+        unsigned height, width;
+        pipe.swap = readWordHeader(fp, &width, &height);
+
+        /* print the ppm header */
+        pipe.blockCols = width / BLOCK_LENGTH;
+        pipe.blockRows = height / BLOCK_LENGTH;
+        struct ppmHeader header = { pipe.blockCols * BLOCK_LENGTH,
+                                    pipe.blockRows * BLOCK_LENGTH,
+                                    DENOMINATOR, false };
+        pipe.header = header;
+        writePpmHeader(stdout, &pipe.header);
+        if (pipe.blockCols == 0 || pipe.blockRows == 0) {
+                return;
+        }
+
+        /* every lane unpacks straight into its bands' scanlines */
+        setUpPipeline(&pipe, fp, threads,
+                      (size_t)pipe.header.width * PIXEL_VALS, false);
+        pipe.read = readBandWords;
+        pipe.convert = unpackBand;
+        pipe.write = printScanlines;
+        runPipeline(&pipe);
+        tearDownPipeline(&pipe);
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: setUpPipeline
+ * Purpose: Make the lanes of a pipeline, with every band of each lane
+ *          waiting in its ring back to the reader
+ * Parameters:
+ *      struct pipeline *pipe : The pipeline, with the size of the image in
+ *                              blocks filled in
+ *                   FILE *in : The file the reader reads from
+ *           unsigned threads : The number of lanes (converting threads)
+ *            size_t rowBytes : The raw bytes in one scanline of the bands
+ *              bool compress : Whether the bands are laid out for 
+ *                              compressing (or decompressing)
+ * Output: n/a
+ * Notes: The lanes must be freed with tearDownPipeline()
+ */
+void setUpPipeline(struct pipeline *pipe, FILE *in, unsigned threads,
+                   size_t rowBytes, bool compress)
+{
+        assert(threads >= 1);
+        pipe->in = in;
+        pipe->rowBytes = rowBytes;
+        pipe->bands = (pipe->blockRows + BAND_ROWS - 1) / BAND_ROWS;
+        pipe->lanes = threads < pipe->bands ? threads : pipe->bands;
+
+        /* a band holds its scanlines and one more row of words */
+        size_t wordRowBytes = pipe->blockCols * sizeof(codeWord);
+        size_t pixelBytes = BAND_ROWS * BLOCK_LENGTH * rowBytes;
+        size_t wordsAt = compress ? 0 : pixelBytes + wordRowBytes - 
+                                        BAND_ROWS * wordRowBytes;
+        size_t pixelsAt = compress ? wordRowBytes : 0;
+
+        pipe->lane = ALLOC(pipe->lanes * sizeof(*pipe->lane));
+        for (unsigned i = 0; i < pipe->lanes; ++i) {
+                struct lane *lane = &pipe->lane[i];
+                lane->pipe = pipe;
+                lane->id = i;
+                lane->empty = newSpscRing(LANE_BANDS);
+                lane->full = newSpscRing(LANE_BANDS);
+                lane->done = newSpscRing(LANE_BANDS);
+                lane->frame = NULL;
+                for (int b = 0; b < LANE_BANDS; ++b) {
+                        struct band *band = &lane->bands[b];
+                        band->buffer = ALLOC(pixelBytes + wordRowBytes);
+                        band->pixels = band->buffer + pixelsAt;
+                        band->words = (codeWord *)(band->buffer + wordsAt);
+                        bool pushed = spscPush(lane->empty, band);
+                        assert(pushed);
+                }
+        }
+}
+
+/*
+ * Name: runPipeline
+ * Purpose: Run the reader and converting threads and write every band out
+ *          in order on this one
+ * Parameters:
+ *      struct pipeline *pipe : The set up pipeline with its stages filled in
+ * Output: n/a
+ * Effects: Every band has been read, converted and written
+ */
+void runPipeline(struct pipeline *pipe)
+{
+        pthread_t reader;
+        pthread_t *converters = ALLOC(pipe->lanes * sizeof(*converters));
+        int err = pthread_create(&reader, NULL, readBands, pipe);
+        assert(err == 0);
+        for (unsigned i = 0; i < pipe->lanes; ++i) {
+                err = pthread_create(&converters[i], NULL, convertBands,
+                                     &pipe->lane[i]);
+                assert(err == 0);
+        }
+
+        /* write each band as its lane finishes it, then hand it back */
+        for (unsigned b = 0; b < pipe->bands; ++b) {
+                struct lane *lane = &pipe->lane[b % pipe->lanes];
+                struct band *band = spscPopWait(lane->done);
+                pipe->write(pipe, band);
+                spscPushWait(lane->empty, band);
+        }
+
+        pthread_join(reader, NULL);
+        for (unsigned i = 0; i < pipe->lanes; ++i) {
+                pthread_join(converters[i], NULL);
+        }
+        FREE(converters);
+}
+
+/*
+ * Name: tearDownPipeline
+ * Purpose: Free the lanes of a pipeline, their rings and their bands
+ * Parameters:
+ *      struct pipeline *pipe : The pipeline (after runPipeline)
+ * Output: n/a
+ */
+void tearDownPipeline(struct pipeline *pipe)
+{
+        for (unsigned i = 0; i < pipe->lanes; ++i) {
+                struct lane *lane = &pipe->lane[i];
+                for (int b = 0; b < LANE_BANDS; ++b) {
+                        FREE(lane->bands[b].buffer);
+                }
+                freeSpscRing(&lane->empty);
+                freeSpscRing(&lane->full);
+                freeSpscRing(&lane->done);
+        }
+        FREE(pipe->lane);
+}
+
+/*
+ * Name: readBands
+ * Purpose: Run by the reader thread. Reads every band in order into an
+ *          empty band of its lane and passes it on to the lane's converter.
+ * Parameters:
+ *      void *pipe : The pipeline
+ * Output: NULL
+ */
+void *readBands(void *pipe)
+{
+        struct pipeline *self = pipe;
+        for (unsigned b = 0; b < self->bands; ++b) {
+                struct lane *lane = &self->lane[b % self->lanes];
+                struct band *band = spscPopWait(lane->empty);
+                band->first = b * BAND_ROWS;
+                band->rows = self->blockRows - band->first < BAND_ROWS ?
+                             self->blockRows - band->first : BAND_ROWS;
+                self->read(self, band);
+                spscPushWait(lane->full, band);
+        }
+        return NULL;
+}
+
+/*
+ * Name: convertBands
+ * Purpose: Run by each converting thread. Converts every band dealt to its
+ *          lane, in order, and passes each on to the writer.
+ * Parameters:
+ *      void *lane : The lane of the calling thread
+ * Output: NULL
+ */
+void *convertBands(void *lane)
+{
+        struct lane *self = lane;
+        struct pipeline *pipe = self->pipe;
+        for (unsigned b = self->id; b < pipe->bands; b += pipe->lanes) {
+                struct band *band = spscPopWait(self->full);
+                pipe->convert(self, band);
+                spscPushWait(self->done, band);
+        }
+        return NULL;
+}
+
+/*
+ * Name: bandScanlines
+ * Purpose: Point at the pair of scanlines a row of blocks of a band covers
+ * Parameters:
+ *          struct pipeline *pipe : The pipeline
+ *              struct band *band : The band
+ *                   unsigned row : The row of blocks within the band
+ *      unsigned char **scanlines : Where to store the BLOCK_LENGTH pointers
+ * Output: n/a
+ */
+void bandScanlines(struct pipeline *pipe, struct band *band, unsigned row,
+                   unsigned char **scanlines)
+{
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                scanlines[i] = band->pixels +
+                               (row * BLOCK_LENGTH + i) * pipe->rowBytes;
+        }
+}
+
+/*
+ * Name: readScanlines
+ * Purpose: Read stage of compression, reads the scanlines of a band
+ * Parameters:
+ *      struct pipeline *pipe : The pipeline
+ *          struct band *band : The band to fill
+ * Output: n/a
+ */
+void readScanlines(struct pipeline *pipe, struct band *band)
+{
+        for (unsigned i = 0; i < band->rows * BLOCK_LENGTH; ++i) {
+                readPpmRow(pipe->in, &pipe->header,
+                           band->pixels + i * pipe->rowBytes);
+        }
+}
+
+/*
+ * Name: packBand
+ * Purpose: Convert stage of compression, packs each pair of scanlines of a
+ *          band into its row of words
+ * Parameters:
+ *      struct lane *lane : The lane of the calling thread
+ *      struct band *band : The band to pack
+ * Output: n/a
+ */
+void packBand(struct lane *lane, struct band *band)
+{
+        struct pipeline *pipe = lane->pipe;
+        unsigned char *scanlines[BLOCK_LENGTH];
+        for (unsigned r = 0; r < band->rows; ++r) {
+                bandScanlines(pipe, band, r, scanlines);
+                packScanlines((const unsigned char **)scanlines,
+                              pipe->blockCols, &pipe->header, pipe->colors,
+                              lane->frame, band->words + r * pipe->blockCols);
+        }
+}
+
+/*
+ * Name: printWords
+ * Purpose: Write stage of compression, prints the words of a band
+ * Parameters:
+ *      struct pipeline *pipe : The pipeline
+ *          struct band *band : The band to print
+ * Output: n/a
+ */
+void printWords(struct pipeline *pipe, struct band *band)
+{
+        writeWords(pipe->writer, band->words, band->rows * pipe->blockCols);
+}
+
+/*
+ * Name: readBandWords
+ * Purpose: Read stage of decompression, reads the words of a band in host
+ *          order
+ * Parameters:
+ *      struct pipeline *pipe : The pipeline
+ *          struct band *band : The band to fill
+ * Output: n/a
+ */
+void readBandWords(struct pipeline *pipe, struct band *band)
+{
+        readWords(pipe->in, band->words, band->rows * pipe->blockCols,
+                  pipe->swap);
+}
+
+/*
+ * Name: unpackBand
+ * Purpose: Convert stage of decompression, unpacks each row of words of a
+ *          band into its pair of scanlines
+ * Parameters:
+ *      struct lane *lane : The lane of the calling thread
+ *      struct band *band : The band to unpack
+ * Output: n/a
+ */
+void unpackBand(struct lane *lane, struct band *band)
+{
+        struct pipeline *pipe = lane->pipe;
+        unsigned char *scanlines[BLOCK_LENGTH];
+        for (unsigned r = 0; r < band->rows; ++r) {
+                bandScanlines(pipe, band, r, scanlines);
+                unpackScanlines(band->words + r * pipe->blockCols,
+                                pipe->blockCols, scanlines);
+        }
+}
+
+/*
+ * Name: printScanlines
+ * Purpose: Write stage of decompression, prints the scanlines of a band
+ * Parameters:
+ *      struct pipeline *pipe : The pipeline
+ *          struct band *band : The band to print
+ * Output: n/a
+ */
+void printScanlines(struct pipeline *pipe, struct band *band)
+{
+        fwrite(band->pixels, 1, band->rows * BLOCK_LENGTH * pipe->rowBytes,
+               stdout);
+}
@@ -0,0 +1,21 @@
+/*
+ * Assignment: arith
+ * Name: pipeline40.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/31/23
+ * Summary: Provides pipelined versions of compress40 and decompress40. A
+ *          reader thread, one or more converting threads and the writing
+ *          (calling) thread pass bands of rows of 2 by 2 blocks along
+ *          lock-free rings, so reading and writing overlap the packing or
+ *          unpacking.
+*/
+
+#ifndef PIPELINE40_H_INCLUDED
+#define PIPELINE40_H_INCLUDED
+
+#include <stdio.h>
+
+void pipelineCompress40(FILE *fp, unsigned threads);
+void pipelineDecompress40(FILE *fp, unsigned threads);
+
+#endif
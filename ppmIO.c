@@ -0,0 +1,448 @@
+/*
+ * Assignment: arith
+ * Name: ppmIO.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/22/23
+ * Summary: Reads and writes the header and the scanlines of a ppm image 
+ *          straight from/to a file so the caller decides how much of the 
+ *          raster is in memory at once. Scanlines are read as the raw bytes 
+ *          of a P6 raster (a P3 raster is parsed into the same bytes), so a 
+ *          whole binary image on disk is simply mapped and used where it lies.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include "ppmIO.h"
+#include "mem.h"
+#include "assert.h"
+
+/* largest sample that fits in a single byte of the raster */
+const unsigned ONE_BYTE_MAXVAL = 255;
+
+/* most buffers (header and scanlines) handed to the kernel in one writev */
+#ifdef IOV_MAX
+#define WRITE_BATCH IOV_MAX
+#else
+#define WRITE_BATCH 1024
+#endif
+
+/* longest possible header ("P6\n" 2 numbers, a max value and whitespace) */
+#define MAX_HEADER_LENGTH 48
+
+/* helper functions */
+static bool readPpmNum(FILE *fp, unsigned *num);
+static void writeAll(int fd, struct iovec *iov, int count);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: readPpmHeader
+ * Purpose: Read the header of a P6 or P3 ppm file and leave the file 
+ *          positioned at the first byte of the raster
+ * Parameters:
+ *                      FILE *fp : The open ppm file to read from
+ *      struct ppmHeader *header : The struct to store the width, height,
+ *                                 denominator and format of the image in
+ * Output: n/a
+ * Effects: The header struct is filled in and the header is consumed from fp
+ * Expectations: The file is a P6 or P3 ppm with a nonzero max value of at 
+ *               most 65535. CRE if not.
+ */
+void readPpmHeader(FILE *fp, struct ppmHeader *header)
+{
+        bool read = tryReadPpmHeader(fp, header);
+        assert(read);
+}
+
+/*
+ * Name: tryReadPpmHeader
+ * Purpose: readPpmHeader for a file that may not be a ppm at all
+ * Parameters:
+ *                      FILE *fp : The open file to read from
+ *      struct ppmHeader *header : The struct to store the header in
+ * Output: true if the file starts with a P6 or P3 header with a nonzero max
+ *         value of at most 65535, false if not
+ * Effects: The header struct is filled in and the header is consumed from fp
+ *          (how much of a bad header is consumed is unspecified)
+ */
+bool tryReadPpmHeader(FILE *fp, struct ppmHeader *header)
+{
+        /* check the magic number */
+        int p = getc(fp);
+        int kind = getc(fp);
+        if (p != 'P' || (kind != '6' && kind != '3')) {
+                return false;
+        }
+        header->plain = kind == '3';
+
+        /* read the dimensions and the max value */
+        if (!readPpmNum(fp, &header->width) || 
+            !readPpmNum(fp, &header->height) ||
+            !readPpmNum(fp, &header->denominator) ||
+            header->denominator == 0 || header->denominator > 65535) {
+                return false;
+        }
+
+        /* a single whitespace char seperates the header from the raster */
+        int c = getc(fp);
+        return c != EOF && isspace(c);
+}
+
+/*
+ * Name: ppmSampleBytes
+ * Purpose: Get the number of bytes each sample takes in the raw raster
+ * Parameters:
+ *      const struct ppmHeader *header : The header of the image
+ * Output: 1, or 2 (big endian) if the max value doesn't fit in 1 byte
+ */
+size_t ppmSampleBytes(const struct ppmHeader *header)
+{
+        return header->denominator > ONE_BYTE_MAXVAL ? 2 : 1;
+}
+
+/*
+ * Name: readPpmRow
+ * Purpose: Read the next scanline of the raster as the raw bytes of a P6 
+ *          raster (red, green and blue samples of ppmSampleBytes each)
+ * Parameters:
+ *                      FILE *fp : The ppm file positioned at a scanline
+ *      struct ppmHeader *header : The header of the image being read
+ *            unsigned char *raw : An array of 3 * width samples to fill
+ * Output: n/a
+ * Effects: raw holds the next scanline and fp is moved past it
+ * Expectations: The file has a full scanline left to read and every sample is
+ *               at most the denominator. CRE if not.
+ */
+void readPpmRow(FILE *fp, struct ppmHeader *header, unsigned char *raw)
+{
+        bool read = tryReadPpmRow(fp, header, raw);
+        assert(read);
+}
+
+/*
+ * Name: tryReadPpmRow
+ * Purpose: readPpmRow for a raster that may be cut short or malformed
+ * Parameters:
+ *                      FILE *fp : The ppm file positioned at a scanline
+ *      struct ppmHeader *header : The header of the image being read
+ *            unsigned char *raw : An array of 3 * width samples to fill
+ * Output: true if a full scanline was read with every sample at most the 
+ *         denominator, false if not
+ * Effects: raw holds the next scanline and fp is moved past it
+ */
+bool tryReadPpmRow(FILE *fp, struct ppmHeader *header, unsigned char *raw)
+{
+        size_t samples = (size_t)header->width * 3;
+        size_t sampleBytes = ppmSampleBytes(header);
+
+        /* a binary scanline is already in the right format */
+        if (!header->plain) {
+                return fread(raw, sampleBytes, samples, fp) == samples;
+        }
+
+        /* parse the ascii samples into raw bytes */
+        for (size_t i = 0; i < samples; ++i) {
+                unsigned sample;
+                if (!readPpmNum(fp, &sample) || 
+                    sample > header->denominator) {
+                        return false;
+                }
+                if (sampleBytes == 1) {
+                        raw[i] = sample;
+                } else {
+                        raw[2 * i] = sample >> 8;
+                        raw[2 * i + 1] = sample & 0xff;
+                }
+        }
+        return true;
+}
+
+/*
+ * Name: readPpmRaster
+ * Purpose: Get at the whole raster of a ppm image as raw P6 samples. The 
+ *          raster of a binary image in a regular file is mapped into memory 
+ *          and used where it lies, anything else is read into memory.
+ * Parameters:
+ *                      FILE *fp : The open ppm file to read from
+ *      struct ppmRaster *raster : The raster to set up
+ * Output: n/a
+ * Notes: The raster must be freed by the caller (freePpmRaster())
+ * Expectations: The file is a P6 or P3 ppm holding its whole raster. CRE if 
+ *               not.
+ */
+void readPpmRaster(FILE *fp, struct ppmRaster *raster)
+{
+        bool read = tryReadPpmRaster(fp, raster);
+        assert(read);
+}
+
+/*
+ * Name: tryReadPpmRaster
+ * Purpose: readPpmRaster for a file that may not be a well formed ppm
+ * Parameters:
+ *                      FILE *fp : The open file to read from
+ *      struct ppmRaster *raster : The raster to set up
+ * Output: true if the raster was set up, false if the file isn't a P6 or P3
+ *         ppm holding its whole raster (nothing is left to free then)
+ * Notes: A raster that was set up must be freed by the caller 
+ *        (freePpmRaster())
+ */
+bool tryReadPpmRaster(FILE *fp, struct ppmRaster *raster)
+{
+        struct ppmHeader *header = &raster->header;
+        if (!tryReadPpmHeader(fp, header)) {
+                return false;
+        }
+        raster->rowBytes = (size_t)header->width * 3 * ppmSampleBytes(header);
+        raster->mapping = NULL;
+        raster->mappedBytes = 0;
+
+        /* a regular file has to be big enough to hold the raster */
+        struct stat info;
+        off_t offset = ftello(fp);
+        bool regular = offset >= 0 && fstat(fileno(fp), &info) == 0 && 
+                       S_ISREG(info.st_mode);
+        if (regular && (info.st_size < offset || 
+                        !ppmRasterFits(header, info.st_size - offset))) {
+                return false;
+        }
+        size_t rasterBytes = raster->rowBytes * header->height;
+
+        /* map a binary image in a regular file and point at its raster */
+        if (!header->plain && rasterBytes > 0 && regular) {
+                void *mapping = mmap(NULL, info.st_size, PROT_READ, 
+                                     MAP_PRIVATE, fileno(fp), 0);
+                if (mapping != MAP_FAILED) {
+                        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+                        raster->mapping = mapping;
+                        raster->mappedBytes = info.st_size;
+                        raster->samples = (unsigned char *)mapping + offset;
+                        return true;
+                }
+        }
+
+        /* otherwise read the raster in one scanline at a time */
+        unsigned char *samples = ALLOC(rasterBytes + 1);
+        for (unsigned row = 0; row < header->height; ++row) {
+                if (!tryReadPpmRow(fp, header, 
+                                   samples + row * raster->rowBytes)) {
+                        FREE(samples);
+                        return false;
+                }
+        }
+        raster->samples = samples;
+        return true;
+}
+
+/*
+ * Name: ppmRasterFits
+ * Purpose: Check that the given number of bytes could hold the raster of an
+ *          image with the given header (without overflowing on a huge one)
+ * Parameters:
+ *      const struct ppmHeader *header : The header of the image
+ *                        size_t bytes : The bytes after the header
+ * Output: true if a binary raster fits exactly or better, or if there is a
+ *         byte per digit and separator for the shortest plain raster (one
+ *         digit per sample, the last separator optional)
+ */
+bool ppmRasterFits(const struct ppmHeader *header, size_t bytes)
+{
+        if (header->width == 0 || header->height == 0) {
+                return true;
+        }
+        size_t rowBytes = (size_t)header->width * 3;
+        if (header->plain) {
+                rowBytes *= 2;
+                bytes += 1;
+        } else {
+                rowBytes *= ppmSampleBytes(header);
+        }
+        return header->height <= bytes / rowBytes;
+}
+
+/*
+ * Name: rasterRow
+ * Purpose: Get the raw samples of the given scanline of the raster
+ * Parameters:
+ *      const struct ppmRaster *raster : The raster of the image
+ *                        unsigned row : The scanline to get
+ * Output: A pointer to the first sample of the scanline
+ * Expectations: row is less than the height of the image. CRE if not.
+ */
+const unsigned char *rasterRow(const struct ppmRaster *raster, unsigned row)
+{
+        assert(row < raster->header.height);
+        return raster->samples + row * raster->rowBytes;
+}
+
+/*
+ * Name: freePpmRaster
+ * Purpose: Unmap or free the samples of the given raster
+ * Parameters:
+ *      struct ppmRaster *raster : The raster to free
+ * Output: n/a
+ */
+void freePpmRaster(struct ppmRaster *raster)
+{
+        if (raster->mapping != NULL) {
+                munmap(raster->mapping, raster->mappedBytes);
+        } else {
+                FREE(raster->samples);
+        }
+        raster->samples = NULL;
+        raster->mapping = NULL;
+}
+
+/*
+ * Name: writePpmHeader
+ * Purpose: Write the header of a P6 ppm file
+ * Parameters:
+ *                      FILE *fp : The file to write the header to
+ *      struct ppmHeader *header : The width, height and denominator to write
+ * Output: n/a
+ * Effects: The header is written to fp in the same format as Pnm_ppmwrite
+ */
+void writePpmHeader(FILE *fp, struct ppmHeader *header)
+{
+        fprintf(fp, "P6\n%u %u\n%u\n", header->width, header->height,
+                header->denominator);
+}
+
+/*
+ * Name: writePpmImage
+ * Purpose: Write a whole P6 ppm image, header and raster, with as few system
+ *          calls as possible. WRITE_BATCH buffers (the header and the 
+ *          scanlines) go to the kernel in each writev, straight from where
+ *          they lie.
+ * Parameters:
+ *                            FILE *fp : The file to write the image to
+ *      const struct ppmHeader *header : The width, height and denominator
+ *          const unsigned char **rows : height pointers to raw P6 scanlines
+ * Output: n/a
+ * Effects: The image is written to fp in the same format as Pnm_ppmwrite.
+ *          Anything already buffered in fp is flushed first.
+ * Expectations: The whole image can be written. CRE if not.
+ */
+void writePpmImage(FILE *fp, const struct ppmHeader *header, 
+                   const unsigned char **rows)
+{
+        /* format the header the same way as writePpmHeader */
+        char text[MAX_HEADER_LENGTH];
+        int length = snprintf(text, sizeof(text), "P6\n%u %u\n%u\n", 
+                              header->width, header->height, 
+                              header->denominator);
+        assert(length > 0 && length < (int)sizeof(text));
+
+        /* anything fp buffered has to go out before the image */
+        fflush(fp);
+        int fd = fileno(fp);
+
+        /* hand the header and the scanlines over in batches */
+        size_t rowBytes = (size_t)header->width * 3 * ppmSampleBytes(header);
+        struct iovec iov[WRITE_BATCH];
+        iov[0].iov_base = text;
+        iov[0].iov_len = length;
+        int count = 1;
+        for (unsigned row = 0; row < header->height; ++row) {
+                iov[count].iov_base = (void *)rows[row];
+                iov[count].iov_len = rowBytes;
+                if (++count == WRITE_BATCH) {
+                        writeAll(fd, iov, count);
+                        count = 0;
+                }
+        }
+        if (count > 0) {
+                writeAll(fd, iov, count);
+        }
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: readPpmNum
+ * Purpose: Read the next unsigned number in a ppm header (or a P3 raster),
+ *          skipping any whitespace and comments before it
+ * Parameters:
+ *          FILE *fp : The ppm file positioned inside the header
+ *      unsigned *num : Where to store the number read
+ * Output: true if a number that fits an unsigned was the next token in the
+ *         file, false if not
+ */
+bool readPpmNum(FILE *fp, unsigned *num)
+{
+        /* skip whitespace and comments (which run to the end of the line) */
+        int c = getc(fp);
+        while (isspace(c) || c == '#') {
+                if (c == '#') {
+                        while (c != '\n' && c != EOF) {
+                                c = getc(fp);
+                        }
+                }
+                c = getc(fp);
+        }
+        if (!isdigit(c)) {
+                return false;
+        }
+
+        /* read in the digits */
+        *num = 0;
+        while (isdigit(c)) {
+                unsigned digit = c - '0';
+                if (*num > (UINT_MAX - digit) / 10) {
+                        return false;
+                }
+                *num = *num * 10 + digit;
+                c = getc(fp);
+        }
+
+        /* give back the char after the number (may seperate the raster) */
+        ungetc(c, fp);
+        return true;
+}
+
+/*
+ * Name: writeAll
+ * Purpose: Write every byte of the given buffers to the given file, picking 
+ *          up where the kernel left off after a short or interrupted write
+ * Parameters:
+ *                 int fd : The file descriptor to write to
+ *      struct iovec *iov : The buffers to write (consumed as they are written)
+ *              int count : The number of buffers
+ * Output: n/a
+ * Expectations: The file can be written to. CRE if not.
+ */
+void writeAll(int fd, struct iovec *iov, int count)
+{
+        while (count > 0) {
+                ssize_t written = writev(fd, iov, count);
+                if (written < 0 && errno == EINTR) {
+                        continue;
+                }
+                assert(written >= 0);
+
+                /* skip the buffers that made it out, trim a partial one */
+                while (count > 0 && (size_t)written >= iov->iov_len) {
+                        written -= iov->iov_len;
+                        iov++;
+                        count--;
+                }
+                if (count > 0) {
+                        iov->iov_base = (char *)iov->iov_base + written;
+                        iov->iov_len -= written;
+                }
+        }
+}
@@ -0,0 +1,50 @@
+/*
+ * Assignment: arith
+ * Name: ppmIO.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/22/23
+ * Summary: Provides functions to read and write a ppm image one header and
+ *          one scanline at a time so that the image never has to be held in
+ *          memory all at once, and to get at the whole raster of an image as
+ *          compact raw samples (mapped straight from the file when possible).
+ *          Each reader has a try variant that reports a malformed file 
+ *          instead of raising a CRE.
+*/
+
+#ifndef PPMIO_H_INCLUDED
+#define PPMIO_H_INCLUDED
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+/* struct to hold the dimensions and max value of a ppm image */
+struct ppmHeader {
+        unsigned width, height, denominator;
+        bool plain;                     /* P3 (ascii) rather than P6 */
+};
+
+/* the whole raster of a ppm image as raw P6 samples */
+struct ppmRaster {
+        struct ppmHeader header;
+        size_t rowBytes;                /* raw bytes in one scanline */
+        unsigned char *samples;         /* height scanlines of R G B samples */
+        void *mapping;                  /* the mapped file, NULL if read in */
+        size_t mappedBytes;
+};
+
+void readPpmHeader(FILE *fp, struct ppmHeader *header);
+bool tryReadPpmHeader(FILE *fp, struct ppmHeader *header);
+size_t ppmSampleBytes(const struct ppmHeader *header);
+void readPpmRow(FILE *fp, struct ppmHeader *header, unsigned char *raw);
+bool tryReadPpmRow(FILE *fp, struct ppmHeader *header, unsigned char *raw);
+void readPpmRaster(FILE *fp, struct ppmRaster *raster);
+bool tryReadPpmRaster(FILE *fp, struct ppmRaster *raster);
+bool ppmRasterFits(const struct ppmHeader *header, size_t bytes);
+const unsigned char *rasterRow(const struct ppmRaster *raster, unsigned row);
+void freePpmRaster(struct ppmRaster *raster);
+void writePpmHeader(FILE *fp, struct ppmHeader *header);
+void writePpmImage(FILE *fp, const struct ppmHeader *header, 
+                   const unsigned char **rows);
+
+#endif
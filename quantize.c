@@ -8,10 +8,16 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <math.h>
 #include "packInfo.h"
 #include "codeWord.h"
-#include "arith40.h"
+#include <pthread.h>
+#include "fixedPoint.h"
+#include "assert.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /* shorten struct names */
 #define quantizedVals struct quantizedVals
@@ -33,6 +39,30 @@ const int BCD_QUANT_VALUE = (BCD_QUANT_RANGE - 1) / PIXEL_RANGE;
 const int QUANT_UPPER_BOUND = BCD_QUANT_RANGE / 2;
 const int QUANT_LOWER_BOUND = BCD_QUANT_RANGE / -2;
 
+/* number of chroma levels (every index that fits in the pb and pr fields) */
+#define CHROMA_LEVELS 16
+
+/* the pb/pr value each chroma index stands for (the levels of Arith40) */
+static const float CHROMA_OF_INDEX[CHROMA_LEVELS] = {
+        -.35, -.20, -.15, -.10, -.077, -.055, -.033, -.011, 
+        .011, .033, .055, .077, .10, .15, .20, .35
+};
+
+/* 
+ * cells per 1.0 of pb/pr in the table of nearest levels. A cell is narrower 
+ * than the gap between any two levels, so at most one halfway point between
+ * levels falls inside it.
+ */
+#define CHROMA_CELLS 256
+
+/* the nearest level to the low edge of every cell from -0.5 to 0.5 */
+static unsigned char chromaCell[CHROMA_CELLS + 1];
+
+/* the chroma levels and the nearest level to every pb/pr in fixed point */
+static int32_t fixedChroma[CHROMA_LEVELS];
+static unsigned char fixedChromaIndex[(1 << FIXED_SHIFT) + 1];
+static pthread_once_t chromaOnce = PTHREAD_ONCE_INIT;
+
 /* helper functions */
 static void pixelToDCT(pixelVals *pVals);
 static void quantizeCoefs(pixelVals *pVals, quantizedVals *qVals);
@@ -40,12 +70,38 @@ static void quantizeChroma(pixelVals *pVals, quantizedVals *qVals);
 static void dequantizeChroma(quantizedVals *qVals, pixelVals *pVals);
 static void dequantizeCoefs(quantizedVals *qVals, pixelVals *pVals);
 static void DCTtoPixel(pixelVals *pVals);
+static int64_t quantizeFixedCoef(int64_t coef4);
+static void buildChromaTables(void);
+static unsigned nearestChroma(float chroma);
+static unsigned searchChroma(float chroma);
+#if defined(__SSE2__)
+static void quantizeVector(const struct blockPlanes *planes, unsigned i, 
+                           const struct quantizedPlanes *qPlanes);
+static void dequantizeVector(const struct quantizedPlanes *qPlanes, 
+                             unsigned i, const struct blockPlanes *planes);
+static __m128i roundVector(__m128 value);
+#endif
 
 
 /*******************************************************************************
 *                            Public Functions                                  *
 *******************************************************************************/
 
+/*
+ * Name: initChroma
+ * Purpose: Set up the tables of chroma levels used to quantize and dequantize
+ *          the average pb and pr of a block. Must be called before quantize,
+ *          dequantize, quantizeFixed or dequantizeFixed.
+ * Parameters: n/a
+ * Output: n/a
+ * Effects: The tables are filled the first time it is called. It is safe to 
+ *          call any number of times from any thread.
+ */
+void initChroma(void)
+{
+        pthread_once(&chromaOnce, buildChromaTables);
+}
+
 /*
  * Name: quantize
  * Purpose: Quantizes the pixel values held in the given pixelVals and saves 
@@ -169,8 +225,61 @@ void quantizeCoefs(pixelVals *pVals, quantizedVals *qVals)
  */
 void quantizeChroma(pixelVals *pVals, quantizedVals *qVals)
 {
-        qVals->pbChroma = Arith40_index_of_chroma(pVals->pbAvg);
-        qVals->prChroma = Arith40_index_of_chroma(pVals->prAvg);
+        qVals->pbChroma = nearestChroma(pVals->pbAvg);
+        qVals->prChroma = nearestChroma(pVals->prAvg);
+}
+
+/*
+ * Name: nearestChroma
+ * Purpose: Find the index of the chroma level nearest the given pb/pr with a 
+ *          table lookup. The level nearest the low edge of the value's cell 
+ *          is the answer or one away from it, so at most one neighbor is 
+ *          checked.
+ * Parameters: 
+ *      float chroma : The average pb or pr of a block
+ * Output: The index of the nearest level, the lowest index if two are just 
+ *         as close (the same index searchChroma gives)
+ */
+unsigned nearestChroma(float chroma)
+{
+        int cell = (chroma + 0.5f) * CHROMA_CELLS;
+        if (cell < 0) {
+                cell = 0;
+        } else if (cell > CHROMA_CELLS) {
+                cell = CHROMA_CELLS;
+        }
+
+        unsigned i = chromaCell[cell];
+        float dist = fabsf(chroma - CHROMA_OF_INDEX[i]);
+        if (i + 1 < CHROMA_LEVELS && 
+            fabsf(chroma - CHROMA_OF_INDEX[i + 1]) < dist) {
+                return i + 1;
+        }
+        if (i > 0 && fabsf(chroma - CHROMA_OF_INDEX[i - 1]) <= dist) {
+                return i - 1;
+        }
+        return i;
+}
+
+/*
+ * Name: searchChroma
+ * Purpose: Find the index of the chroma level nearest the given pb/pr by 
+ *          checking every level
+ * Parameters: 
+ *      float chroma : The pb or pr value
+ * Output: The index of the nearest level, the lowest index if two are just 
+ *         as close
+ */
+unsigned searchChroma(float chroma)
+{
+        unsigned nearest = 0;
+        for (unsigned i = 1; i < CHROMA_LEVELS; ++i) {
+                if (fabsf(chroma - CHROMA_OF_INDEX[i]) < 
+                    fabsf(chroma - CHROMA_OF_INDEX[nearest])) {
+                        nearest = i;
+                }
+        }
+        return nearest;
 }
 
 
@@ -192,8 +301,8 @@ void quantizeChroma(pixelVals *pVals, quantizedVals *qVals)
  */
 void dequantizeChroma(quantizedVals *qVals, pixelVals *pVals)
 {
-        pVals->pbAvg = Arith40_chroma_of_index(qVals->pbChroma);
-        pVals->prAvg = Arith40_chroma_of_index(qVals->prChroma);
+        pVals->pbAvg = CHROMA_OF_INDEX[qVals->pbChroma];
+        pVals->prAvg = CHROMA_OF_INDEX[qVals->prChroma];
 }
 
 /*
@@ -238,5 +347,330 @@ void DCTtoPixel(pixelVals *pVals)
         pVals->Y4 = a + b + c + d;
 }
 
+
+/*******************************************************************************
+*                       Batched (Planar) Quantize Functions                    *
+*******************************************************************************/
+
+/*
+ * Name: quantizePlanes
+ * Purpose: Quantize a batch of blocks given as planes, giving exactly the 
+ *          values quantize gives for each block. With SSE2 the DCT and the 
+ *          coefficients of 4 blocks are worked out at once.
+ * Parameters: 
+ *          const struct blockPlanes *planes : The Y values and average pb 
+ *                                             and pr of each block
+ *                            unsigned count : The number of blocks
+ *      const struct quantizedPlanes *qPlanes : The planes to store the 
+ *                                              quantized values in
+ * Output: n/a
+ * Effects: The first count values of every quantized plane are filled
+ */
+void quantizePlanes(const struct blockPlanes *planes, unsigned count, 
+                    const struct quantizedPlanes *qPlanes)
+{
+        unsigned i = 0;
+#if defined(__SSE2__)
+        for (; i + 4 <= count; i += 4) {
+                quantizeVector(planes, i, qPlanes);
+        }
+#endif
+        for (; i < count; ++i) {
+                pixelVals pVals = { planes->Y1[i], planes->Y2[i], 
+                                    planes->Y3[i], planes->Y4[i], 0, 0 };
+                quantizedVals qVals;
+                pixelToDCT(&pVals);
+                quantizeCoefs(&pVals, &qVals);
+                qPlanes->qA[i] = qVals.qA;
+                qPlanes->qB[i] = qVals.qB;
+                qPlanes->qC[i] = qVals.qC;
+                qPlanes->qD[i] = qVals.qD;
+        }
+
+        /* the chroma is a table lookup for each block */
+        for (i = 0; i < count; ++i) {
+                qPlanes->pbChroma[i] = nearestChroma(planes->pbAvg[i]);
+                qPlanes->prChroma[i] = nearestChroma(planes->prAvg[i]);
+        }
+}
+
+/*
+ * Name: dequantizePlanes
+ * Purpose: Dequantize a batch of quantized blocks given as planes, giving 
+ *          exactly the values dequantize gives for each block. With SSE2 the
+ *          coefficients and the inverse DCT of 4 blocks are worked out at 
+ *          once.
+ * Parameters: 
+ *      const struct quantizedPlanes *qPlanes : The quantized values of each
+ *                                              block
+ *                             unsigned count : The number of blocks
+ *          const struct blockPlanes *planes : The planes to store the Y 
+ *                                             values and the pb and pr in
+ * Output: n/a
+ * Effects: The first count values of every plane are filled
+ */
+void dequantizePlanes(const struct quantizedPlanes *qPlanes, unsigned count,
+                      const struct blockPlanes *planes)
+{
+        unsigned i = 0;
+#if defined(__SSE2__)
+        for (; i + 4 <= count; i += 4) {
+                dequantizeVector(qPlanes, i, planes);
+        }
+#endif
+        for (; i < count; ++i) {
+                quantizedVals qVals = { qPlanes->qA[i], qPlanes->qB[i], 
+                                        qPlanes->qC[i], qPlanes->qD[i], 0, 0 };
+                pixelVals pVals;
+                dequantizeCoefs(&qVals, &pVals);
+                DCTtoPixel(&pVals);
+                planes->Y1[i] = pVals.Y1;
+                planes->Y2[i] = pVals.Y2;
+                planes->Y3[i] = pVals.Y3;
+                planes->Y4[i] = pVals.Y4;
+        }
+
+        for (i = 0; i < count; ++i) {
+                planes->pbAvg[i] = CHROMA_OF_INDEX[qPlanes->pbChroma[i]];
+                planes->prAvg[i] = CHROMA_OF_INDEX[qPlanes->prChroma[i]];
+        }
+}
+
+#if defined(__SSE2__)
+/*
+ * Name: quantizeVector
+ * Purpose: Do the DCT and quantize the coefficients of 4 blocks at once, with
+ *          the same single precision ops as pixelToDCT and quantizeCoefs
+ * Parameters: 
+ *          const struct blockPlanes *planes : The Y values of the blocks
+ *                                unsigned i : The first of the 4 blocks
+ *      const struct quantizedPlanes *qPlanes : The planes to store the 
+ *                                              quantized coefficients in
+ * Output: n/a
+ * Notes: Clamping b, c and d before rounding gives the same value as 
+ *        clamping after, since the bounds are whole numbers
+ */
+void quantizeVector(const struct blockPlanes *planes, unsigned i, 
+                    const struct quantizedPlanes *qPlanes)
+{
+        __m128 Y1 = _mm_loadu_ps(planes->Y1 + i);
+        __m128 Y2 = _mm_loadu_ps(planes->Y2 + i);
+        __m128 Y3 = _mm_loadu_ps(planes->Y3 + i);
+        __m128 Y4 = _mm_loadu_ps(planes->Y4 + i);
+
+        /* convert the Y values to cosine coefficients */
+        __m128 coefs = _mm_set1_ps(NUM_COEFFICIENTS);
+        __m128 a = _mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(Y4, Y3), Y2),
+                                         Y1), coefs);
+        __m128 b = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(_mm_add_ps(Y4, Y3), Y2),
+                                         Y1), coefs);
+        __m128 c = _mm_div_ps(_mm_sub_ps(_mm_add_ps(_mm_sub_ps(Y4, Y3), Y2),
+                                         Y1), coefs);
+        __m128 d = _mm_div_ps(_mm_add_ps(_mm_sub_ps(_mm_sub_ps(Y4, Y3), Y2),
+                                         Y1), coefs);
+
+        /* quantize them, keeping b, c and d between the bounds */
+        __m128 bcdScale = _mm_set1_ps(BCD_QUANT_VALUE);
+        __m128 upper = _mm_set1_ps(QUANT_UPPER_BOUND);
+        __m128 lower = _mm_set1_ps(QUANT_LOWER_BOUND);
+        a = _mm_mul_ps(a, _mm_set1_ps(A_QUANT_VALUE));
+        b = _mm_min_ps(upper, _mm_max_ps(lower, _mm_mul_ps(b, bcdScale)));
+        c = _mm_min_ps(upper, _mm_max_ps(lower, _mm_mul_ps(c, bcdScale)));
+        d = _mm_min_ps(upper, _mm_max_ps(lower, _mm_mul_ps(d, bcdScale)));
+        _mm_storeu_si128((__m128i *)(qPlanes->qA + i), roundVector(a));
+        _mm_storeu_si128((__m128i *)(qPlanes->qB + i), roundVector(b));
+        _mm_storeu_si128((__m128i *)(qPlanes->qC + i), roundVector(c));
+        _mm_storeu_si128((__m128i *)(qPlanes->qD + i), roundVector(d));
+}
+
+/*
+ * Name: dequantizeVector
+ * Purpose: Dequantize the coefficients of 4 blocks and reverse the DCT at 
+ *          once, with the same single precision ops as dequantizeCoefs and 
+ *          DCTtoPixel
+ * Parameters: 
+ *      const struct quantizedPlanes *qPlanes : The quantized coefficients
+ *                                 unsigned i : The first of the 4 blocks
+ *          const struct blockPlanes *planes : The planes to store the Y 
+ *                                             values in
+ * Output: n/a
+ */
+void dequantizeVector(const struct quantizedPlanes *qPlanes, unsigned i, 
+                      const struct blockPlanes *planes)
+{
+        __m128 bcdScale = _mm_set1_ps(BCD_QUANT_VALUE);
+        __m128 a = _mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128(
+                        (const __m128i *)(qPlanes->qA + i))), 
+                        _mm_set1_ps(A_QUANT_VALUE));
+        __m128 b = _mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128(
+                        (const __m128i *)(qPlanes->qB + i))), bcdScale);
+        __m128 c = _mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128(
+                        (const __m128i *)(qPlanes->qC + i))), bcdScale);
+        __m128 d = _mm_div_ps(_mm_cvtepi32_ps(_mm_loadu_si128(
+                        (const __m128i *)(qPlanes->qD + i))), bcdScale);
+
+        /* reverse the DCT to get the Y vals */
+        _mm_storeu_ps(planes->Y1 + i, 
+                      _mm_add_ps(_mm_sub_ps(_mm_sub_ps(a, b), c), d));
+        _mm_storeu_ps(planes->Y2 + i, 
+                      _mm_sub_ps(_mm_add_ps(_mm_sub_ps(a, b), c), d));
+        _mm_storeu_ps(planes->Y3 + i, 
+                      _mm_sub_ps(_mm_sub_ps(_mm_add_ps(a, b), c), d));
+        _mm_storeu_ps(planes->Y4 + i, 
+                      _mm_add_ps(_mm_add_ps(_mm_add_ps(a, b), c), d));
+}
+
+/*
+ * Name: roundVector
+ * Purpose: Round 4 floats to the nearest int, halves away from zero, exactly
+ *          like round(). The part after the point (the float minus its 
+ *          truncation) is exact, so comparing it to a half is too.
+ * Parameters: 
+ *      __m128 value : The floats, each less than 2^31 in size
+ * Output: The rounded ints
+ */
+__m128i roundVector(__m128 value)
+{
+        __m128i whole = _mm_cvttps_epi32(value);
+        __m128 part = _mm_sub_ps(value, _mm_cvtepi32_ps(whole));
+        __m128i up = _mm_castps_si128(_mm_cmpge_ps(part, _mm_set1_ps(0.5f)));
+        __m128i down = _mm_castps_si128(_mm_cmple_ps(part, 
+                                                     _mm_set1_ps(-0.5f)));
+
+        /* a true compare is -1, so subtracting it adds 1 */
+        return _mm_add_epi32(_mm_sub_epi32(whole, up), down);
+}
+#endif
+
+
+/*******************************************************************************
+*                      Fixed Point (-x) Quantize Functions                     *
+*******************************************************************************/
+
+/*
+ * Name: quantizeFixed
+ * Purpose: Quantize the fixed point pixel values held in the given fixedVals
+ *          using only integer math and save the quantized values in the given
+ *          quantizedVals struct
+ * Parameters: 
+ *          fixedVals *fVals : The Y values and average pb and pr of a block,
+ *                             scaled by 2^FIXED_SHIFT
+ *      quantizedVals *qVals : A pointer to the struct that stores the 
+ *                             quantized values 
+ * Output: n/a
+ * Effects: The given quantizedVals struct is updated with the quantized values
+ * Expectations: The Y values are between 0 and 1 and pb and pr are between 
+ *               -0.5 and 0.5. CRE if not.
+ */
+void quantizeFixed(struct fixedVals *fVals, quantizedVals *qVals)
+{
+        /* 4 times the DCT coefficients (the divide is folded into rounding) */
+        int64_t Y1 = fVals->Y1, Y2 = fVals->Y2, Y3 = fVals->Y3; 
+        int64_t Y4 = fVals->Y4;
+        int64_t a4 = Y4 + Y3 + Y2 + Y1;
+        int64_t b4 = Y4 + Y3 - Y2 - Y1;
+        int64_t c4 = Y4 - Y3 + Y2 - Y1;
+        int64_t d4 = Y4 - Y3 - Y2 + Y1;
+
+        /* quantize the DCT coefficients */
+        assert(a4 >= 0 && a4 <= 4 * FIXED_ONE);
+        qVals->qA = roundShift(a4 * A_QUANT_VALUE, FIXED_SHIFT + 2);
+        qVals->qB = quantizeFixedCoef(b4);
+        qVals->qC = quantizeFixedCoef(c4);
+        qVals->qD = quantizeFixedCoef(d4);
+
+        /* quantize the chroma */
+        assert(labs(fVals->pbAvg) <= FIXED_ONE / 2);
+        assert(labs(fVals->prAvg) <= FIXED_ONE / 2);
+        qVals->pbChroma = fixedChromaIndex[fVals->pbAvg + FIXED_ONE / 2];
+        qVals->prChroma = fixedChromaIndex[fVals->prAvg + FIXED_ONE / 2];
+}
+
+/*
+ * Name: dequantizeFixed
+ * Purpose: Dequantize the quantized values held in the given struct using 
+ *          only integer math and save the fixed point values in the given 
+ *          fixedVals struct
+ * Parameters: 
+ *      quantizedVals *qVals : A pointer to the struct that contians the 
+ *                             quantized values 
+ *          fixedVals *fVals : The struct to store the Y values and the pb 
+ *                             and pr of the block in (scaled by 
+ *                             2^FIXED_SHIFT)
+ * Output: n/a
+ * Effects: The given fixedVals struct is updated with the dequantized values
+ */
+void dequantizeFixed(quantizedVals *qVals, struct fixedVals *fVals)
+{
+        /* dequantize the chroma */
+        fVals->pbAvg = fixedChroma[qVals->pbChroma];
+        fVals->prAvg = fixedChroma[qVals->prChroma];
+
+        /* dequantize the coefficents */
+        int64_t a = roundDiv((int64_t)qVals->qA * FIXED_ONE, A_QUANT_VALUE);
+        int64_t b = roundDiv(qVals->qB * FIXED_ONE, BCD_QUANT_VALUE);
+        int64_t c = roundDiv(qVals->qC * FIXED_ONE, BCD_QUANT_VALUE);
+        int64_t d = roundDiv(qVals->qD * FIXED_ONE, BCD_QUANT_VALUE);
+
+        /* update Y vals be reversing the DCT */
+        fVals->Y1 = a - b - c + d;
+        fVals->Y2 = a - b + c - d;
+        fVals->Y3 = a + b - c - d;
+        fVals->Y4 = a + b + c + d;
+}
+
+/*
+ * Name: quantizeFixedCoef
+ * Purpose: Quantize a b, c or d DCT coefficient given as 4 times its fixed
+ *          point value, keeping it between the upper and lower bound
+ * Parameters: 
+ *      int64_t coef4 : 4 times the coefficient, scaled by 2^FIXED_SHIFT
+ * Output: The quantized coefficient
+ */
+int64_t quantizeFixedCoef(int64_t coef4)
+{
+        int64_t quantized = roundShift(coef4 * BCD_QUANT_VALUE, 
+                                       FIXED_SHIFT + 2);
+        if (quantized > QUANT_UPPER_BOUND) {
+                return QUANT_UPPER_BOUND;
+        } else if (quantized < QUANT_LOWER_BOUND) {
+                return QUANT_LOWER_BOUND;
+        }
+        return quantized;
+}
+
 #undef quantizedVals
 #undef pixelVals
+
+/*
+ * Name: buildChromaTables
+ * Purpose: Fill the table of the nearest level to the low edge of each cell,
+ *          and the fixed point chroma levels and the table of the nearest 
+ *          level to every fixed point pb/pr value
+ * Parameters: n/a
+ * Output: n/a
+ * Effects: The chroma tables are filled. The nearest level is the one with 
+ *          the lowest index if two are just as close.
+ */
+void buildChromaTables(void)
+{
+        assert(CHROMA_LEVELS == 1 << PB_WIDTH);
+        for (int cell = 0; cell <= CHROMA_CELLS; ++cell) {
+                chromaCell[cell] = searchChroma((float)cell / CHROMA_CELLS - 
+                                                0.5f);
+        }
+
+        for (int i = 0; i < CHROMA_LEVELS; ++i) {
+                fixedChroma[i] = lroundf(CHROMA_OF_INDEX[i] * FIXED_ONE);
+        }
+        for (int32_t v = -FIXED_ONE / 2; v <= FIXED_ONE / 2; ++v) {
+                int nearest = 0;
+                for (int i = 1; i < CHROMA_LEVELS; ++i) {
+                        if (labs(fixedChroma[i] - v) < 
+                            labs(fixedChroma[nearest] - v)) {
+                                nearest = i;
+                        }
+                }
+                fixedChromaIndex[v + FIXED_ONE / 2] = nearest;
+        }
+}
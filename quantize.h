@@ -12,7 +12,15 @@
 #include <stdio.h>
 #include "packInfo.h"
 
+void initChroma(void);
 void quantize(struct pixelVals *pVals, struct quantizedVals *qVals);
 void dequantize(struct quantizedVals *qVals, struct pixelVals *pVals);
+void quantizePlanes(const struct blockPlanes *planes, unsigned count, 
+                    const struct quantizedPlanes *qPlanes);
+void dequantizePlanes(const struct quantizedPlanes *qPlanes, unsigned count,
+                      const struct blockPlanes *planes);
+
+void quantizeFixed(struct fixedVals *fVals, struct quantizedVals *qVals);
+void dequantizeFixed(struct quantizedVals *qVals, struct fixedVals *fVals);
 
 #endif
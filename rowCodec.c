@@ -0,0 +1,322 @@
+/*
+ * Assignment: arith
+ * Name: rowCodec.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/24/23
+ * Summary: Converts and packs/unpacks whole scanlines of pixels at a time. A
+ *          pair of scanlines makes up one row of 2 by 2 blocks, which packs
+ *          into one row of codeWords. Packing converts the raw samples of a 
+ *          pair of P6 scanlines a whole scanline at a time, and unpacking 
+ *          converts batches of blocks straight to raw 8 bit samples. Either
+ *          can be done in float or (with useFixedPoint) in integer math.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include "rowCodec.h"
+#include "codeWord.h"
+#include "pack.h"
+#include "quantize.h"
+#include "RGBcompvConvert.h"
+#include "cvFrame.h"
+#include "assert.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/* number of blocks gathered into planes (or unpacked) at a time */
+#define BLOCK_BATCH 64u
+
+/* whether the fixed point (integer) codec is used instead of float */
+static bool fixedPoint = false;
+
+/* whether words are unpacked with the decode tables */
+static bool tableDecode = false;
+
+/* helper funcs */
+static void gatherBlocks(const struct cvFrame *frame, unsigned first, 
+                         unsigned count, const struct blockPlanes *planes);
+static void packFixed(const unsigned char **scanlines, unsigned blocks, 
+                      const struct ppmHeader *header, struct cvFrame *frame,
+                      codeWord *words);
+static void unpackFixed(const codeWord *words, unsigned count, 
+                        unsigned char **scanlines);
+
+
+/*******************************************************************************
+*                        Compression Row Functions                             *
+*******************************************************************************/
+
+/*
+ * Name: useFixedPoint
+ * Purpose: Choose between the float codec and the fixed point codec, which 
+ *          uses only integer math and gives the same bits on any host
+ * Parameters:
+ *      bool fixed : Whether to use the fixed point codec
+ * Output: n/a
+ * Effects: Every row packed or unpacked after the call uses the chosen codec
+ * Notes: Must be called before any threads start packing or unpacking
+ */
+void useFixedPoint(bool fixed)
+{
+        fixedPoint = fixed;
+}
+
+/*
+ * Name: useTableDecode
+ * Purpose: Choose whether the float codec unpacks words with lookup tables
+ *          (decodeBlocks) instead of dequantizing them (unpackBlocks). Both
+ *          give the same pixels.
+ * Parameters:
+ *      bool table : Whether to unpack with the tables
+ * Output: n/a
+ * Effects: Every row unpacked after the call uses the chosen decoder
+ * Notes: Must be called before any threads start unpacking
+ */
+void useTableDecode(bool table)
+{
+        tableDecode = table;
+}
+
+/*
+ * Name: packScanlines
+ * Purpose: Convert a pair of raw scanlines to component video and pack every
+ *          2 by 2 block in them into the given row of words
+ * Parameters:
+ *      const unsigned char **scanlines : The BLOCK_LENGTH raw P6 scanlines
+ *                      unsigned blocks : The number of blocks across them
+ *       const struct ppmHeader *header : The header of the image
+ *      const struct colorTable *colors : The color table made for the 
+ *                                        image's denominator
+ *                struct cvFrame *frame : A scratch frame of at least 
+ *                                        BLOCK_LENGTH * blocks by 
+ *                                        BLOCK_LENGTH pixels to convert the
+ *                                        scanlines into (ints for the fixed
+ *                                        point codec)
+ *                      codeWord *words : The row of words to pack into
+ * Output: n/a
+ * Effects: The row of words is filled with the packed blocks
+ */
+void packScanlines(const unsigned char **scanlines, unsigned blocks, 
+                   const struct ppmHeader *header, 
+                   const struct colorTable *colors, 
+                   struct cvFrame *frame, codeWord *words)
+{
+        assert(frame->width >= blocks * BLOCK_LENGTH && 
+               frame->height >= BLOCK_LENGTH);
+        initChroma();
+        if (fixedPoint) {
+                packFixed(scanlines, blocks, header, frame, words);
+                return;
+        }
+
+        /* convert the whole pair of scanlines (less any odd column) */
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                size_t row = i * frame->stride;
+                rowToCompV(scanlines[i], ppmSampleBytes(header), 
+                           blocks * BLOCK_LENGTH, colors, frame->Y + row,
+                           frame->Pb + row, frame->Pr + row);
+        }
+
+        /* gather batches of blocks into planes and pack them */
+        float Y1[BLOCK_BATCH], Y2[BLOCK_BATCH], Y3[BLOCK_BATCH], 
+              Y4[BLOCK_BATCH], pbAvg[BLOCK_BATCH], prAvg[BLOCK_BATCH];
+        struct blockPlanes planes = { Y1, Y2, Y3, Y4, pbAvg, prAvg };
+        for (unsigned b = 0; b < blocks; b += BLOCK_BATCH) {
+                unsigned count = blocks - b < BLOCK_BATCH ? blocks - b 
+                                                          : BLOCK_BATCH;
+                gatherBlocks(frame, b, count, &planes);
+                packBlocks(&planes, count, words + b);
+        }
+}
+
+
+/*******************************************************************************
+*                        Decompression Row Functions                           *
+*******************************************************************************/
+
+/*
+ * Name: unpackScanlines
+ * Purpose: Unpack every word in the given row and convert the 2 by 2 blocks 
+ *          straight into the raw 8 bit RGB samples of a pair of scanlines
+ * Parameters:
+ *        const codeWord *words : The row of words to unpack
+ *              unsigned blocks : The number of words in the row
+ *      unsigned char **scanlines : The BLOCK_LENGTH scanlines to fill
+ * Output: n/a
+ * Effects: The scanlines hold the unpacked pixels with a max value of 
+ *          DENOMINATOR
+ */
+void unpackScanlines(const codeWord *words, unsigned blocks, 
+                     unsigned char **scanlines)
+{
+        initChroma();
+        float Y1[BLOCK_BATCH], Y2[BLOCK_BATCH], Y3[BLOCK_BATCH], 
+              Y4[BLOCK_BATCH], pbAvg[BLOCK_BATCH], prAvg[BLOCK_BATCH];
+        struct blockPlanes planes = { Y1, Y2, Y3, Y4, pbAvg, prAvg };
+        for (unsigned b = 0; b < blocks; b += BLOCK_BATCH) {
+                unsigned count = blocks - b < BLOCK_BATCH ? blocks - b 
+                                                          : BLOCK_BATCH;
+                unsigned char *batch[BLOCK_LENGTH];
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        batch[i] = scanlines[i] + 
+                                   b * BLOCK_LENGTH * PIXEL_VALS;
+                }
+                if (fixedPoint) {
+                        unpackFixed(words + b, count, batch);
+                        continue;
+                }
+
+                /* unpack a batch of words into planes then convert them */
+                if (tableDecode) {
+                        decodeBlocks(words + b, count, &planes);
+                } else {
+                        unpackBlocks(words + b, count, &planes);
+                }
+                blocksToRGB(&planes, count, DENOMINATOR, batch);
+        }
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: gatherBlocks
+ * Purpose: Gather a batch of 2 by 2 blocks from the first 2 rows of a frame
+ *          into planes of their 4 Y values and the averages of their pb and
+ *          pr (added up in the same order as packWord). With SSE2 the even
+ *          and odd columns of 4 blocks are split apart at once.
+ * Parameters:
+ *       const struct cvFrame *frame : The frame holding the converted pixels
+ *                    unsigned first : The index of the first block to gather
+ *                    unsigned count : The number of blocks, at most 
+ *                                     BLOCK_BATCH
+ *      const struct blockPlanes *planes : The planes to fill
+ * Output: n/a
+ * Effects: The first count values of each plane are filled
+ */
+void gatherBlocks(const struct cvFrame *frame, unsigned first, 
+                  unsigned count, const struct blockPlanes *planes)
+{
+        const float *Y[BLOCK_LENGTH], *Pb[BLOCK_LENGTH], *Pr[BLOCK_LENGTH];
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                size_t offset = i * frame->stride + first * BLOCK_LENGTH;
+                Y[i] = frame->Y + offset;
+                Pb[i] = frame->Pb + offset;
+                Pr[i] = frame->Pr + offset;
+        }
+        const float blockSize = BLOCK_LENGTH * BLOCK_LENGTH;
+        unsigned b = 0;
+
+#if defined(__SSE2__)
+        __m128 size = _mm_set1_ps(blockSize);
+        for (; b + 4 <= count; b += 4) {
+                /* split the 8 pixels of each row into left and right */
+                unsigned col = b * BLOCK_LENGTH;
+                __m128 left[3][BLOCK_LENGTH], right[3][BLOCK_LENGTH];
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        const float *rows[3] = { Y[i], Pb[i], Pr[i] };
+                        for (int p = 0; p < 3; ++p) {
+                                __m128 lo = _mm_loadu_ps(rows[p] + col);
+                                __m128 hi = _mm_loadu_ps(rows[p] + col + 4);
+                                left[p][i] = _mm_shuffle_ps(lo, hi, 
+                                                _MM_SHUFFLE(2, 0, 2, 0));
+                                right[p][i] = _mm_shuffle_ps(lo, hi, 
+                                                _MM_SHUFFLE(3, 1, 3, 1));
+                        }
+                }
+                _mm_storeu_ps(planes->Y1 + b, left[0][0]);
+                _mm_storeu_ps(planes->Y2 + b, right[0][0]);
+                _mm_storeu_ps(planes->Y3 + b, left[0][1]);
+                _mm_storeu_ps(planes->Y4 + b, right[0][1]);
+
+                /* top left + top right + bottom left + bottom right */
+                __m128 pb = _mm_add_ps(_mm_add_ps(_mm_add_ps(left[1][0], 
+                                right[1][0]), left[1][1]), right[1][1]);
+                __m128 pr = _mm_add_ps(_mm_add_ps(_mm_add_ps(left[2][0], 
+                                right[2][0]), left[2][1]), right[2][1]);
+                _mm_storeu_ps(planes->pbAvg + b, _mm_div_ps(pb, size));
+                _mm_storeu_ps(planes->prAvg + b, _mm_div_ps(pr, size));
+        }
+#endif
+
+        /* the rest one block at a time */
+        for (; b < count; ++b) {
+                unsigned left = b * BLOCK_LENGTH, right = left + 1;
+                planes->Y1[b] = Y[0][left];
+                planes->Y2[b] = Y[0][right];
+                planes->Y3[b] = Y[1][left];
+                planes->Y4[b] = Y[1][right];
+                planes->pbAvg[b] = (Pb[0][left] + Pb[0][right] + 
+                                    Pb[1][left] + Pb[1][right]) / blockSize;
+                planes->prAvg[b] = (Pr[0][left] + Pr[0][right] + 
+                                    Pr[1][left] + Pr[1][right]) / blockSize;
+        }
+}
+
+/*
+ * Name: packFixed
+ * Purpose: packScanlines for the fixed point codec
+ * Parameters:
+ *      const unsigned char **scanlines : The BLOCK_LENGTH raw P6 scanlines
+ *                      unsigned blocks : The number of blocks across them
+ *       const struct ppmHeader *header : The header of the image
+ *                struct cvFrame *frame : The scratch frame to convert the 
+ *                                        scanlines into, as ints
+ *                      codeWord *words : The row of words to pack into
+ * Output: n/a
+ * Effects: The row of words is filled with the packed blocks
+ */
+void packFixed(const unsigned char **scanlines, unsigned blocks, 
+               const struct ppmHeader *header, struct cvFrame *frame, 
+               codeWord *words)
+{
+        /* the planes of the frame hold ints for the fixed point codec */
+        int32_t *Y[BLOCK_LENGTH], *Pb[BLOCK_LENGTH], *Pr[BLOCK_LENGTH];
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                size_t row = i * frame->stride;
+                Y[i] = (int32_t *)(frame->Y + row);
+                Pb[i] = (int32_t *)(frame->Pb + row);
+                Pr[i] = (int32_t *)(frame->Pr + row);
+                rowToCompVFixed(scanlines[i], ppmSampleBytes(header), 
+                                blocks * BLOCK_LENGTH, header->denominator,
+                                Y[i], Pb[i], Pr[i]);
+        }
+
+        int32_t vals[BLOCK_LENGTH * BLOCK_LENGTH][PIXEL_VALS];
+        int32_t *pix[BLOCK_LENGTH * BLOCK_LENGTH];
+        for (unsigned b = 0; b < blocks; ++b) {
+                for (int i = 0; i < BLOCK_LENGTH * BLOCK_LENGTH; ++i) {
+                        unsigned col = b * BLOCK_LENGTH + i % BLOCK_LENGTH;
+                        vals[i][0] = Y[i / BLOCK_LENGTH][col];
+                        vals[i][1] = Pb[i / BLOCK_LENGTH][col];
+                        vals[i][2] = Pr[i / BLOCK_LENGTH][col];
+                        pix[i] = vals[i];
+                }
+                words[b] = 0;
+                packWordFixed(pix, &words[b]);
+        }
+}
+
+/*
+ * Name: unpackFixed
+ * Purpose: Unpack and convert a batch of words with the fixed point codec
+ * Parameters:
+ *          const codeWord *words : The words to unpack
+ *                 unsigned count : The number of words, at most BLOCK_BATCH
+ *      unsigned char **scanlines : The BLOCK_LENGTH scanlines to fill
+ * Output: n/a
+ * Effects: The first count blocks of the scanlines are filled
+ */
+void unpackFixed(const codeWord *words, unsigned count, 
+                 unsigned char **scanlines)
+{
+        struct fixedVals vals[BLOCK_BATCH];
+        for (unsigned i = 0; i < count; ++i) {
+                unpackValsFixed(words[i], &vals[i]);
+        }
+        blocksToRGBFixed(vals, count, DENOMINATOR, scanlines);
+}
@@ -0,0 +1,33 @@
+/*
+ * Assignment: arith
+ * Name: rowCodec.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/24/23
+ * Summary: Provides functions to pack a pair of raw P6 scanlines into a row of
+ *          codeWords, and to unpack a row of codeWords back into a pair of
+ *          raw 8 bit RGB scanlines.
+*/
+
+#ifndef ROWCODEC_H_INCLUDED
+#define ROWCODEC_H_INCLUDED
+
+#include <stdbool.h>
+#include "codeWord.h"
+#include "ppmIO.h"
+#include "RGBcompvConvert.h"
+#include "cvFrame.h"
+
+/* number of values (R G B or Y Pb Pr) that make up one pixel */
+static const int PIXEL_VALS = 3;
+
+void useFixedPoint(bool fixed);
+void useTableDecode(bool table);
+void packScanlines(const unsigned char **scanlines, unsigned blocks, 
+                   const struct ppmHeader *header, 
+                   const struct colorTable *colors, 
+                   struct cvFrame *frame, 
+                   codeWord *words);
+void unpackScanlines(const codeWord *words, unsigned blocks, 
+                     unsigned char **scanlines);
+
+#endif
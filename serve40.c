@@ -0,0 +1,664 @@
+/*
+ * Assignment: arith
+ * Name: serve40.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/31/23
+ * Summary: Serves compress and decompress requests over a Unix domain socket
+ *          on a pool of threads. The main thread accepts connections and
+ *          queues them; each worker takes a connection and answers its
+ *          requests until the client hangs up. A worker keeps its codec
+ *          context and request buffer from request to request, so a small
+ *          image costs no process start, no allocation and no file I/O.
+ *          Each request is parsed where it lies in memory and run through
+ *          the in-memory codec of comp40.c, and the reply is built in the
+ *          context's arena and sent with one write.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "serve40.h"
+#include "comp40.h"
+#include "codecContext.h"
+#include "arena.h"
+#include "ppmIO.h"
+#include "wordIO.h"
+#include "mem.h"
+#include "assert.h"
+
+/* connections accepted but not yet taken by a worker */
+#define PENDING_CONNECTIONS 64
+
+/* room in a reply for the header of a ppm or compressed file */
+static const size_t HEADER_ROOM = 128;
+
+/*
+ * a request buffer grows by at least this much at a time, as the payload
+ * arrives, and a worker that served a request bigger than KEEP_BYTES gives
+ * its buffers back rather than keeping them for the rest of its life
+ */
+static const size_t READ_CHUNK = 64 << 10;
+static const size_t KEEP_BYTES = 4 << 20;
+
+/* the biggest payload a request may carry (set by serve40) */
+static uint64_t maxPayload = SERVE_DEFAULT_MAX_PAYLOAD;
+
+/* whether the workers' codec contexts use huge pages (set by serve40) */
+static bool hugeArenas = false;
+
+/* connections waiting for a worker, oldest at the front */
+struct connectionQueue {
+        int fds[PENDING_CONNECTIONS];
+        unsigned front, count;
+        pthread_mutex_t lock;
+        pthread_cond_t ready;           /* a connection was queued */
+        pthread_cond_t room;            /* a connection was taken */
+};
+
+/* what a worker keeps from one request to the next */
+struct serveWorker {
+        struct codecContext *context;
+        unsigned char *request;         /* the payload of the request */
+        size_t capacity;
+};
+
+/* set by SIGINT or SIGTERM to stop accepting connections */
+static volatile sig_atomic_t stopping = 0;
+
+/* helper funcs */
+static int listenOn(const char *socketPath);
+static void stopServing(int signal);
+static void pushConnection(struct connectionQueue *queue, int fd);
+static int popConnection(struct connectionQueue *queue);
+static void *runWorker(void *queue);
+static void serveConnection(struct serveWorker *worker, int fd);
+static bool readPayload(struct serveWorker *worker, int fd, size_t length);
+static void dropBuffers(struct serveWorker *worker);
+static const char *compressRequest(struct codecContext *context,
+                                   unsigned char *request, size_t bytes,
+                                   unsigned char **reply, size_t *replyBytes);
+static const char *decompressRequest(struct codecContext *context,
+                                     unsigned char *request, size_t bytes,
+                                     unsigned char **reply,
+                                     size_t *replyBytes);
+static bool fitsIn(size_t rowBytes, unsigned rows, size_t bytes);
+static void putFrame(unsigned char *frame, int status, uint64_t length);
+static bool sendError(int fd, const char *message);
+static bool readAll(int fd, void *buffer, size_t bytes);
+static bool sendAll(int fd, const void *buffer, size_t bytes);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: serve40
+ * Purpose: Listen on the given socket and answer compress and decompress
+ *          requests (see serve40.h) on a pool of threads until SIGINT or
+ *          SIGTERM arrives
+ * Parameters:
+ *      const char *socketPath : The path to make the socket at (a stale
+ *                               socket there is replaced)
+ *            unsigned threads : The number of workers in the pool
+ *         uint64_t maxRequest : The biggest payload a request may carry
+ *                               (bigger ones get an error reply)
+ *              bool hugePages : Whether big images' scratch memory should be
+ *                               backed by huge pages (when the kernel 
+ *                               allows it)
+ * Output: false if the socket couldn't be made (reported on stderr), true
+ *         once the daemon has been stopped
+ * Effects: The socket is removed again when the daemon stops. The workers
+ *          and any connections they hold are left to the caller's exit.
+ * Expectations: threads and maxRequest are at least 1. CRE if not.
+ * Notes: A request that isn't a well formed file gets an error reply, so a
+ *        client can't bring down the daemon or another client's connection
+ */
+bool serve40(const char *socketPath, unsigned threads, uint64_t maxRequest,
+             bool hugePages)
+{
+        assert(socketPath != NULL && threads >= 1 && maxRequest >= 1);
+        maxPayload = maxRequest;
+        hugeArenas = hugePages;
+        int listener = listenOn(socketPath);
+        if (listener < 0) {
+                fprintf(stderr, "40image: can't listen on %s: %s\n",
+                        socketPath, strerror(errno));
+                return false;
+        }
+
+        /* a stop interrupts accept, and only this thread takes it */
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = stopServing;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGINT, &action, NULL);
+        sigaction(SIGTERM, &action, NULL);
+        sigset_t stops, mask;
+        sigemptyset(&stops);
+        sigaddset(&stops, SIGINT);
+        sigaddset(&stops, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &stops, &mask);
+
+        /* start the pool (the queue outlives this call with the workers) */
+        struct connectionQueue *queue;
+        NEW(queue);
+        queue->front = 0;
+        queue->count = 0;
+        pthread_mutex_init(&queue->lock, NULL);
+        pthread_cond_init(&queue->ready, NULL);
+        pthread_cond_init(&queue->room, NULL);
+        for (unsigned i = 0; i < threads; ++i) {
+                pthread_t id;
+                int err = pthread_create(&id, NULL, runWorker, queue);
+                assert(err == 0);
+                pthread_detach(id);
+        }
+        pthread_sigmask(SIG_SETMASK, &mask, NULL);
+
+        /* hand each connection to the pool */
+        while (!stopping) {
+                int fd = accept(listener, NULL, NULL);
+                if (fd >= 0) {
+                        pushConnection(queue, fd);
+                } else if (errno != EINTR && errno != ECONNABORTED) {
+                        fprintf(stderr, "40image: accept failed: %s\n",
+                                strerror(errno));
+                        break;
+                }
+        }
+
+        close(listener);
+        unlink(socketPath);
+        return true;
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: listenOn
+ * Purpose: Make a Unix domain stream socket at the given path and listen on
+ *          it
+ * Parameters:
+ *      const char *socketPath : The path of the socket
+ * Output: The listening socket, or -1 (with errno set) if it couldn't be made
+ * Effects: A stale socket at the path is unlinked first (anything else there
+ *          is left alone and makes the bind fail)
+ */
+int listenOn(const char *socketPath)
+{
+        struct sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (strlen(socketPath) >= sizeof(address.sun_path)) {
+                errno = ENAMETOOLONG;
+                return -1;
+        }
+        strcpy(address.sun_path, socketPath);
+
+        struct stat info;
+        if (lstat(socketPath, &info) == 0 && S_ISSOCK(info.st_mode)) {
+                unlink(socketPath);
+        }
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) {
+                return -1;
+        }
+        if (bind(fd, (struct sockaddr *)&address, sizeof(address)) != 0 ||
+            listen(fd, SOMAXCONN) != 0) {
+                int err = errno;
+                close(fd);
+                errno = err;
+                return -1;
+        }
+        return fd;
+}
+
+/*
+ * Name: stopServing
+ * Purpose: Signal handler for SIGINT and SIGTERM, stops the accept loop
+ * Parameters:
+ *      int signal : The signal (unused)
+ * Output: n/a
+ */
+void stopServing(int signal)
+{
+        (void)signal;
+        stopping = 1;
+}
+
+/*
+ * Name: pushConnection
+ * Purpose: Queue an accepted connection for the pool, waiting for room if
+ *          PENDING_CONNECTIONS are already queued
+ * Parameters:
+ *      struct connectionQueue *queue : The queue of the pool
+ *                             int fd : The connection
+ * Output: n/a
+ */
+void pushConnection(struct connectionQueue *queue, int fd)
+{
+        pthread_mutex_lock(&queue->lock);
+        while (queue->count == PENDING_CONNECTIONS) {
+                pthread_cond_wait(&queue->room, &queue->lock);
+        }
+        queue->fds[(queue->front + queue->count) % PENDING_CONNECTIONS] = fd;
+        queue->count++;
+        pthread_cond_signal(&queue->ready);
+        pthread_mutex_unlock(&queue->lock);
+}
+
+/*
+ * Name: popConnection
+ * Purpose: Take the oldest queued connection, waiting for one if there are
+ *          none
+ * Parameters:
+ *      struct connectionQueue *queue : The queue of the pool
+ * Output: The connection
+ */
+int popConnection(struct connectionQueue *queue)
+{
+        pthread_mutex_lock(&queue->lock);
+        while (queue->count == 0) {
+                pthread_cond_wait(&queue->ready, &queue->lock);
+        }
+        int fd = queue->fds[queue->front];
+        queue->front = (queue->front + 1) % PENDING_CONNECTIONS;
+        queue->count--;
+        pthread_cond_signal(&queue->room);
+        pthread_mutex_unlock(&queue->lock);
+        return fd;
+}
+
+/*
+ * Name: runWorker
+ * Purpose: Run by each thread in the pool. Serves one connection after
+ *          another with the same codec context and request buffer.
+ * Parameters:
+ *      void *queue : The connectionQueue of the pool
+ * Output: Never returns
+ */
+void *runWorker(void *queue)
+{
+        struct serveWorker worker;
+        worker.context = newCodecContext(hugeArenas);
+        worker.request = NULL;
+        worker.capacity = 0;
+
+        for (;;) {
+                int fd = popConnection(queue);
+                serveConnection(&worker, fd);
+                close(fd);
+        }
+        return NULL;
+}
+
+/*
+ * Name: serveConnection
+ * Purpose: Answer the requests of a connection one at a time until the
+ *          client hangs up
+ * Parameters:
+ *      struct serveWorker *worker : The calling thread's worker
+ *                          int fd : The connection
+ * Output: n/a
+ * Effects: A request with an unknown op or too big a payload gets an error
+ *          reply and ends the connection, since the rest of the stream can't
+ *          be trusted. A payload that isn't a well formed file just gets an
+ *          error reply.
+ */
+void serveConnection(struct serveWorker *worker, int fd)
+{
+        unsigned char frame[SERVE_FRAME_BYTES];
+        while (readAll(fd, frame, SERVE_FRAME_BYTES)) {
+                uint64_t length = 0;
+                for (int i = 1; i < SERVE_FRAME_BYTES; ++i) {
+                        length = length << 8 | frame[i];
+                }
+                char op = frame[0];
+                if (op != SERVE_COMPRESS && op != SERVE_DECOMPRESS) {
+                        sendError(fd, "unknown op");
+                        return;
+                } else if (length == 0 || length > maxPayload) {
+                        sendError(fd, "bad payload length");
+                        return;
+                }
+                if (!readPayload(worker, fd, length)) {
+                        return;
+                }
+
+                unsigned char *reply;
+                size_t replyBytes;
+                const char *error = op == SERVE_COMPRESS ?
+                        compressRequest(worker->context, worker->request,
+                                        length, &reply, &replyBytes) :
+                        decompressRequest(worker->context, worker->request,
+                                          length, &reply, &replyBytes);
+                bool sent = error != NULL ? sendError(fd, error) :
+                                            sendAll(fd, reply, replyBytes);
+                if (length > KEEP_BYTES) {
+                        dropBuffers(worker);
+                }
+                if (!sent) {
+                        return;
+                }
+        }
+}
+
+/*
+ * Name: readPayload
+ * Purpose: Read the payload of a request into the worker's buffer, growing
+ *          the buffer only as the bytes arrive so a client can't make the
+ *          worker hold memory for a payload it never sends
+ * Parameters:
+ *      struct serveWorker *worker : The calling thread's worker
+ *                          int fd : The connection
+ *                   size_t length : The length of the payload
+ * Output: true if the whole payload was read, false if the client hung up
+ *         first
+ */
+bool readPayload(struct serveWorker *worker, int fd, size_t length)
+{
+        size_t got = 0;
+        while (got < length) {
+                if (got == worker->capacity) {
+                        size_t capacity = 2 * worker->capacity;
+                        if (capacity < READ_CHUNK) {
+                                capacity = READ_CHUNK;
+                        }
+                        worker->capacity = capacity < length ? capacity
+                                                             : length;
+                        if (worker->request == NULL) {
+                                worker->request = ALLOC(worker->capacity);
+                        } else {
+                                RESIZE(worker->request, worker->capacity);
+                        }
+                }
+                size_t want = (worker->capacity < length ? worker->capacity
+                                                         : length) - got;
+                if (!readAll(fd, worker->request + got, want)) {
+                        return false;
+                }
+                got += want;
+        }
+        return true;
+}
+
+/*
+ * Name: dropBuffers
+ * Purpose: Give back the request buffer and the codec context (whose arena
+ *          grew to fit the reply) after a big request
+ * Parameters:
+ *      struct serveWorker *worker : The calling thread's worker
+ * Output: n/a
+ * Effects: The worker starts again with no buffer and a fresh context
+ */
+void dropBuffers(struct serveWorker *worker)
+{
+        FREE(worker->request);
+        worker->capacity = 0;
+        freeCodecContext(&worker->context);
+        worker->context = newCodecContext(hugeArenas);
+}
+
+/*
+ * Name: compressRequest
+ * Purpose: Compress the ppm file of a request into a reply frame
+ * Parameters:
+ *      struct codecContext *context : The calling thread's context
+ *            unsigned char *request : The ppm file
+ *                      size_t bytes : The size of the file
+ *             unsigned char **reply : Where to store the reply frame
+ *                size_t *replyBytes : Where to store the size of the frame
+ * Output: NULL, or a message saying why the file couldn't be compressed
+ * Notes: The reply belongs to the context's arena and is only good until
+ *        its next image
+ */
+const char *compressRequest(struct codecContext *context,
+                            unsigned char *request, size_t bytes,
+                            unsigned char **reply, size_t *replyBytes)
+{
+        /* read the header where it lies and check the raster is all there */
+        struct ppmHeader header;
+        FILE *in = fmemopen(request, bytes, "r");
+        assert(in != NULL);
+        if (!tryReadPpmHeader(in, &header)) {
+                fclose(in);
+                return "bad ppm header";
+        }
+        size_t offset = ftello(in);
+        size_t rowBytes = (size_t)header.width * 3 * ppmSampleBytes(&header);
+        if (!ppmRasterFits(&header, bytes - offset)) {
+                fclose(in);
+                return "ppm raster is cut short";
+        }
+
+        /* room for a plain raster read in, the words and the reply */
+        unsigned width = header.width / BLOCK_LENGTH;
+        unsigned height = header.height / BLOCK_LENGTH;
+        size_t words = comp40Words(header.width, header.height);
+        size_t rawBytes = header.plain ? rowBytes * header.height : 0;
+        size_t frameBytes = SERVE_FRAME_BYTES + HEADER_ROOM +
+                            words * sizeof(codeWord);
+        struct arena *arena = contextArena(context,
+                                           arenaSpace(rawBytes) +
+                                           arenaSpace(words *
+                                                      sizeof(codeWord)) +
+                                           arenaSpace(frameBytes));
+        const unsigned char *pixels = request + offset;
+        if (header.plain) {
+                unsigned char *raw = arenaAlloc(arena, rawBytes);
+                for (unsigned row = 0; row < header.height; ++row) {
+                        if (!tryReadPpmRow(in, &header,
+                                           raw + row * rowBytes)) {
+                                fclose(in);
+                                return "bad ppm sample";
+                        }
+                }
+                pixels = raw;
+        }
+        fclose(in);
+
+        /* pack the words, then print them into the reply like compress40 */
+        codeWord *packed = arenaAlloc(arena, words * sizeof(codeWord));
+        comp40Compress(context, pixels, rowBytes, header.width,
+                       header.height, header.denominator, packed, width);
+        *reply = arenaAlloc(arena, frameBytes);
+        FILE *out = fmemopen(*reply + SERVE_FRAME_BYTES,
+                             frameBytes - SERVE_FRAME_BYTES, "w");
+        assert(out != NULL);
+        writeWordHeader(out, width * BLOCK_LENGTH, height * BLOCK_LENGTH);
+        writeWordsInPlace(out, packed, words);
+        fflush(out);
+        size_t length = ftello(out);
+        fclose(out);
+
+        putFrame(*reply, SERVE_OK, length);
+        *replyBytes = SERVE_FRAME_BYTES + length;
+        return NULL;
+}
+
+/*
+ * Name: decompressRequest
+ * Purpose: Decompress the compressed file of a request into a reply frame
+ * Parameters:
+ *      struct codecContext *context : The calling thread's context
+ *            unsigned char *request : The compressed file
+ *                      size_t bytes : The size of the file
+ *             unsigned char **reply : Where to store the reply frame
+ *                size_t *replyBytes : Where to store the size of the frame
+ * Output: NULL, or a message saying why the file couldn't be decompressed
+ * Notes: The reply belongs to the context's arena and is only good until
+ *        its next image
+ */
+const char *decompressRequest(struct codecContext *context,
+                              unsigned char *request, size_t bytes,
+                              unsigned char **reply, size_t *replyBytes)
+{
+        /* read the header where it lies and check the words are all there */
+        unsigned width, height;
+        bool swap;
+        FILE *in = fmemopen(request, bytes, "r");
+        assert(in != NULL);
+        bool read = tryReadWordHeader(in, &width, &height, &swap);
+        size_t offset = ftello(in);
+        fclose(in);
+        if (!read) {
+                return "bad compressed header";
+        }
+        unsigned cols = width / BLOCK_LENGTH;
+        unsigned rows = height / BLOCK_LENGTH;
+        if (!fitsIn((size_t)cols * sizeof(codeWord), rows, bytes - offset)) {
+                return "compressed payload is cut short";
+        }
+
+        /* room for a row of host order words and the reply */
+        struct ppmHeader header = { cols * BLOCK_LENGTH, rows * BLOCK_LENGTH,
+                                    DENOMINATOR, false };
+        size_t rowBytes = (size_t)header.width * 3;
+        size_t frameBytes = SERVE_FRAME_BYTES + HEADER_ROOM +
+                            rowBytes * header.height;
+        struct arena *arena = contextArena(context,
+                                           arenaSpace(cols *
+                                                      sizeof(codeWord)) +
+                                           arenaSpace(frameBytes));
+        codeWord *row = arenaAlloc(arena, cols * sizeof(codeWord));
+        *reply = arenaAlloc(arena, frameBytes);
+
+        /* print the header like decompress40, then unpack the pixels after */
+        FILE *out = fmemopen(*reply + SERVE_FRAME_BYTES, HEADER_ROOM, "w");
+        assert(out != NULL);
+        writePpmHeader(out, &header);
+        fflush(out);
+        size_t headerBytes = ftello(out);
+        fclose(out);
+        unsigned char *pixels = *reply + SERVE_FRAME_BYTES + headerBytes;
+        const unsigned char *payload = request + offset;
+        for (unsigned r = 0; r < rows; ++r) {
+                wordsToHost(payload + (size_t)r * cols * sizeof(codeWord),
+                            row, cols, swap);
+                comp40Decompress(row, cols, cols, 1,
+                                 pixels + r * BLOCK_LENGTH * rowBytes,
+                                 rowBytes);
+        }
+
+        size_t length = headerBytes + rowBytes * header.height;
+        putFrame(*reply, SERVE_OK, length);
+        *replyBytes = SERVE_FRAME_BYTES + length;
+        return NULL;
+}
+
+/*
+ * Name: fitsIn
+ * Purpose: Check that the given number of rows fit in the given bytes
+ *          (without overflowing on a huge header)
+ * Parameters:
+ *      size_t rowBytes : The bytes in each row
+ *        unsigned rows : The number of rows
+ *         size_t bytes : The bytes there are
+ * Output: true if rowBytes * rows is at most bytes
+ */
+bool fitsIn(size_t rowBytes, unsigned rows, size_t bytes)
+{
+        return rowBytes == 0 || rows <= bytes / rowBytes;
+}
+
+/*
+ * Name: putFrame
+ * Purpose: Fill in the header of a reply frame
+ * Parameters:
+ *      unsigned char *frame : The first SERVE_FRAME_BYTES of the frame
+ *                int status : SERVE_OK or SERVE_ERROR
+ *           uint64_t length : The length of the payload after the header
+ * Output: n/a
+ */
+void putFrame(unsigned char *frame, int status, uint64_t length)
+{
+        frame[0] = status;
+        for (int i = SERVE_FRAME_BYTES - 1; i > 0; --i) {
+                frame[i] = length & 0xff;
+                length >>= 8;
+        }
+}
+
+/*
+ * Name: sendError
+ * Purpose: Send an error reply holding the given message
+ * Parameters:
+ *                   int fd : The connection
+ *      const char *message : The message (without a newline)
+ * Output: true if the reply was sent
+ */
+bool sendError(int fd, const char *message)
+{
+        unsigned char frame[SERVE_FRAME_BYTES + HEADER_ROOM];
+        size_t length = strlen(message);
+        assert(length <= HEADER_ROOM);
+        putFrame(frame, SERVE_ERROR, length);
+        memcpy(frame + SERVE_FRAME_BYTES, message, length);
+        return sendAll(fd, frame, SERVE_FRAME_BYTES + length);
+}
+
+/*
+ * Name: readAll
+ * Purpose: Read exactly the given number of bytes from a connection
+ * Parameters:
+ *            int fd : The connection
+ *      void *buffer : Where to put the bytes
+ *      size_t bytes : The number of bytes
+ * Output: true if every byte was read, false if the client hung up or the
+ *         read failed first
+ */
+bool readAll(int fd, void *buffer, size_t bytes)
+{
+        unsigned char *next = buffer;
+        while (bytes > 0) {
+                ssize_t got = read(fd, next, bytes);
+                if (got < 0 && errno == EINTR) {
+                        continue;
+                } else if (got <= 0) {
+                        return false;
+                }
+                next += got;
+                bytes -= got;
+        }
+        return true;
+}
+
+/*
+ * Name: sendAll
+ * Purpose: Send every one of the given bytes over a connection
+ * Parameters:
+ *                  int fd : The connection
+ *      const void *buffer : The bytes
+ *            size_t bytes : The number of bytes
+ * Output: true if every byte was sent, false if the client hung up first
+ *         (without raising SIGPIPE)
+ */
+bool sendAll(int fd, const void *buffer, size_t bytes)
+{
+        const unsigned char *next = buffer;
+        while (bytes > 0) {
+                ssize_t sent = send(fd, next, bytes, MSG_NOSIGNAL);
+                if (sent < 0 && errno == EINTR) {
+                        continue;
+                } else if (sent < 0) {
+                        return false;
+                }
+                next += sent;
+                bytes -= sent;
+        }
+        return true;
+}
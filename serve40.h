@@ -0,0 +1,42 @@
+/*
+ * Assignment: arith
+ * Name: serve40.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/31/23
+ * Summary: Provides a long running codec daemon that listens on a Unix domain
+ *          socket and compresses or decompresses the images sent to it.
+ *          Every request and reply is one frame: a SERVE_FRAME_BYTES header
+ *          (an op or status byte then the payload length as a big endian
+ *          64 bit number) followed by the payload. A compress request
+ *          carries a ppm file and its reply the compressed file; a
+ *          decompress request carries a compressed file and its reply the
+ *          ppm. Both are byte for byte what 40image -c and -d print. A
+ *          failed request gets a SERVE_ERROR reply holding a message. A
+ *          connection may send any number of requests, one at a time, each
+ *          at most the daemon's max request size.
+*/
+
+#ifndef SERVE40_H_INCLUDED
+#define SERVE40_H_INCLUDED
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* the op byte of a request */
+#define SERVE_COMPRESS 'c'
+#define SERVE_DECOMPRESS 'd'
+
+/* the status byte of a reply */
+#define SERVE_OK 0
+#define SERVE_ERROR 1
+
+/* bytes in the header of a frame (op or status, then the length) */
+#define SERVE_FRAME_BYTES 9
+
+/* the biggest payload a request may carry unless told otherwise */
+#define SERVE_DEFAULT_MAX_PAYLOAD ((uint64_t)64 << 20)
+
+bool serve40(const char *socketPath, unsigned threads, uint64_t maxRequest,
+             bool hugePages);
+
+#endif
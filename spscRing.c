@@ -0,0 +1,183 @@
+/*
+ * Assignment: arith
+ * Name: spscRing.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/31/23
+ * Summary: Implements the single producer, single consumer ring. The
+ *          producer publishes a slot by storing the head after the slot
+ *          (release) and the consumer frees it by storing the tail after
+ *          reading it, so the only synchronisation is a pair of acquire
+ *          loads. A side that finds the ring full or empty spins briefly,
+ *          then yields, then sleeps, so a stage waiting on slow I/O doesn't
+ *          keep a core busy.
+ */
+
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include "spscRing.h"
+#include "mem.h"
+#include "assert.h"
+
+/* bytes kept between the indices so they never share a cache line */
+#define CACHE_LINE 64
+
+/* failed tries before a waiting side yields, and then sleeps */
+static const unsigned SPIN_TRIES = 64;
+static const unsigned YIELD_TRIES = 256;
+static const long SLEEP_NANOS = 50000;
+
+struct spscRing {
+        void **slots;
+        size_t mask;                    /* capacity - 1 */
+        char padHead[CACHE_LINE];
+        size_t head;                    /* next slot pushed, producer's */
+        char padTail[CACHE_LINE - sizeof(size_t)];
+        size_t tail;                    /* next slot popped, consumer's */
+        char padEnd[CACHE_LINE - sizeof(size_t)];
+};
+
+/* helper funcs */
+static void backOff(unsigned *tries);
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: newSpscRing
+ * Purpose: Create an empty ring
+ * Parameters:
+ *      size_t capacity : The most items the ring holds, a power of 2
+ * Output: The new ring
+ * Notes: The ring must be freed with freeSpscRing()
+ * Expectations: capacity is a power of 2. CRE if not.
+ */
+struct spscRing *newSpscRing(size_t capacity)
+{
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        struct spscRing *ring;
+        NEW(ring);
+        ring->slots = ALLOC(capacity * sizeof(*ring->slots));
+        ring->mask = capacity - 1;
+        ring->head = 0;
+        ring->tail = 0;
+        return ring;
+}
+
+/*
+ * Name: freeSpscRing
+ * Purpose: Free a ring (not the items still in it)
+ * Parameters:
+ *      struct spscRing **ring : A pointer to the ring
+ * Output: n/a
+ * Effects: *ring is set to NULL
+ */
+void freeSpscRing(struct spscRing **ring)
+{
+        assert(ring != NULL && *ring != NULL);
+        FREE((*ring)->slots);
+        FREE(*ring);
+}
+
+/*
+ * Name: spscPush
+ * Purpose: Add an item to the ring. Only the producer may call this.
+ * Parameters:
+ *      struct spscRing *ring : The ring
+ *                 void *item : The item, not NULL
+ * Output: true if the item was added, false if the ring is full
+ */
+bool spscPush(struct spscRing *ring, void *item)
+{
+        assert(item != NULL);
+        size_t head = ring->head;
+        size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head - tail > ring->mask) {
+                return false;
+        }
+        ring->slots[head & ring->mask] = item;
+        __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+        return true;
+}
+
+/*
+ * Name: spscPop
+ * Purpose: Take the oldest item from the ring. Only the consumer may call
+ *          this.
+ * Parameters:
+ *      struct spscRing *ring : The ring
+ * Output: The item, or NULL if the ring is empty
+ */
+void *spscPop(struct spscRing *ring)
+{
+        size_t tail = ring->tail;
+        size_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (tail == head) {
+                return NULL;
+        }
+        void *item = ring->slots[tail & ring->mask];
+        __atomic_store_n(&ring->tail, tail + 1, __ATOMIC_RELEASE);
+        return item;
+}
+
+/*
+ * Name: spscPushWait
+ * Purpose: Add an item to the ring, waiting for room if it is full
+ * Parameters:
+ *      struct spscRing *ring : The ring
+ *                 void *item : The item, not NULL
+ * Output: n/a
+ */
+void spscPushWait(struct spscRing *ring, void *item)
+{
+        unsigned tries = 0;
+        while (!spscPush(ring, item)) {
+                backOff(&tries);
+        }
+}
+
+/*
+ * Name: spscPopWait
+ * Purpose: Take the oldest item from the ring, waiting for one if it is
+ *          empty
+ * Parameters:
+ *      struct spscRing *ring : The ring
+ * Output: The item
+ */
+void *spscPopWait(struct spscRing *ring)
+{
+        unsigned tries = 0;
+        void *item;
+        while ((item = spscPop(ring)) == NULL) {
+                backOff(&tries);
+        }
+        return item;
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: backOff
+ * Purpose: Wait a little before trying the ring again, longer the more tries
+ *          have failed
+ * Parameters:
+ *      unsigned *tries : The failed tries so far (incremented)
+ * Output: n/a
+ */
+void backOff(unsigned *tries)
+{
+        ++*tries;
+        if (*tries < SPIN_TRIES) {
+                return;
+        } else if (*tries < YIELD_TRIES) {
+                sched_yield();
+        } else {
+                struct timespec nap = { 0, SLEEP_NANOS };
+                nanosleep(&nap, NULL);
+        }
+}
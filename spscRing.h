@@ -0,0 +1,27 @@
+/*
+ * Assignment: arith
+ * Name: spscRing.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/31/23
+ * Summary: Provides a bounded ring of pointers for handing work from exactly
+ *          one producer thread to exactly one consumer thread without a
+ *          lock. Each side only writes its own index, and the two indices
+ *          sit on separate cache lines so the threads don't fight over one.
+*/
+
+#ifndef SPSCRING_H_INCLUDED
+#define SPSCRING_H_INCLUDED
+
+#include <stddef.h>
+#include <stdbool.h>
+
+struct spscRing;
+
+struct spscRing *newSpscRing(size_t capacity);
+void freeSpscRing(struct spscRing **ring);
+bool spscPush(struct spscRing *ring, void *item);
+void *spscPop(struct spscRing *ring);
+void spscPushWait(struct spscRing *ring, void *item);
+void *spscPopWait(struct spscRing *ring);
+
+#endif
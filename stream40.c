@@ -0,0 +1,140 @@
+/*
+ * Assignment: arith
+ * Name: stream40.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/22/23
+ * Summary: Compresses a ppm file two scanlines at a time or decompresses a
+ *          compressed file one row of codeWords at a time. Each row is
+ *          converted and printed to stdout before the next one is read, so
+ *          the whole image is never in memory.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "stream40.h"
+#include "codeWord.h"
+#include "ppmIO.h"
+#include "rowCodec.h"
+#include "wordIO.h"
+#include "RGBcompvConvert.h"
+#include "cvFrame.h"
+#include "mem.h"
+
+
+/*******************************************************************************
+*                            Public Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: streamCompress40
+ * Purpose: Compress each 2 by 2 block of pixels in the given ppm into 32 bit
+ *          words and print the compressed image to stdout, holding only one
+ *          row of blocks in memory at a time.
+ * Parameters:
+ *      FILE *fp : file pointer that contains the ppm file to compress
+ * Output: n/a
+ * Effects: The compressed file is printed to stdout exactly as compress40
+ *          would print it.
+ * Expectations: fp holds a P6 or P3 ppm file. CRE if not.
+ */
+void streamCompress40(FILE *fp)
+{
+        /* read in only the header of the image */
+        struct ppmHeader header;
+        readPpmHeader(fp, &header);
+
+        /* print the header (omits odd width/height) */
+        unsigned blockCols = header.width / BLOCK_LENGTH;
+        unsigned blockRows = header.height / BLOCK_LENGTH;
+        writeWordHeader(stdout, blockCols * BLOCK_LENGTH, 
+                        blockRows * BLOCK_LENGTH);
+        if (blockCols == 0 || blockRows == 0) {
+                return;
+        }
+
+        /* allocate one row of blocks worth of scanlines, frame and words */
+        unsigned char *rows[BLOCK_LENGTH];
+        const unsigned char *scanlines[BLOCK_LENGTH];
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                rows[i] = ALLOC(header.width * PIXEL_VALS * 
+                                ppmSampleBytes(&header));
+                scanlines[i] = rows[i];
+        }
+        struct cvFrame *frame = newCvFrame(blockCols * BLOCK_LENGTH, 
+                                           BLOCK_LENGTH);
+        codeWord *words = ALLOC(blockCols * sizeof(codeWord));
+        struct colorTable *colors = newColorTable(header.denominator);
+        struct wordWriter *writer = newWordWriter(stdout);
+
+        /* read, convert, pack and print one row of blocks at a time */
+        for (unsigned r = 0; r < blockRows; ++r) {
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        readPpmRow(fp, &header, rows[i]);
+                }
+                packScanlines(scanlines, blockCols, &header, colors, 
+                              frame, words);
+                writeWords(writer, words, blockCols);
+        }
+
+        /* flush the writer and free the color table, frame and rows */
+        freeWordWriter(&writer);
+        freeColorTable(&colors);
+        freeCvFrame(&frame);
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                FREE(rows[i]);
+        }
+        FREE(words);
+}
+
+/*
+ * Name: streamDecompress40
+ * Purpose: Decompress the given file (32 bit words -> pixels) and print out
+ *          the decompressed ppm image to stdout, holding only one row of
+ *          codeWords in memory at a time.
+ * Parameters:
+ *      FILE *fp : A file pointer to the compressed ppm file
+ * Output: The decompressed file is written to stdout as a P6 ppm file exactly
+ *         as decompress40 would write it.
+ * Expectations: The given file pointer is formatted correctly. CRE if not.
+ */
+void streamDecompress40(FILE *fp)
+{
+        /* read in header */
+        unsigned height, width;
+        bool swap = readWordHeader(fp, &width, &height);
+
+        /* print the ppm header */
+        unsigned blockCols = width / BLOCK_LENGTH;
+        unsigned blockRows = height / BLOCK_LENGTH;
+        struct ppmHeader header = { blockCols * BLOCK_LENGTH,
+                                    blockRows * BLOCK_LENGTH, DENOMINATOR,
+                                    false };
+        writePpmHeader(stdout, &header);
+        if (blockCols == 0 || blockRows == 0) {
+                return;
+        }
+
+        /* allocate one row of words and the scanlines it unpacks into */
+        size_t rowBytes = header.width * PIXEL_VALS;
+        unsigned char *rows[BLOCK_LENGTH];
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                rows[i] = ALLOC(rowBytes);
+        }
+        codeWord *words = ALLOC(blockCols * sizeof(codeWord));
+
+        /* read, unpack, convert and print one row of words at a time */
+        for (unsigned r = 0; r < blockRows; ++r) {
+                readWords(fp, words, blockCols, swap);
+                unpackScanlines(words, blockCols, rows);
+                for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                        fwrite(rows[i], 1, rowBytes, stdout);
+                }
+        }
+
+        /* free the row buffers */
+        for (int i = 0; i < BLOCK_LENGTH; ++i) {
+                FREE(rows[i]);
+        }
+        FREE(words);
+}
@@ -0,0 +1,19 @@
+/*
+ * Assignment: arith
+ * Name: stream40.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/22/23
+ * Summary: Provides streaming versions of compress40 and decompress40 that 
+ *          work through the image one row of 2 by 2 blocks at a time, so 
+ *          memory use depends only on the width of the image.
+*/
+
+#ifndef STREAM40_H_INCLUDED
+#define STREAM40_H_INCLUDED
+
+#include <stdio.h>
+
+void streamCompress40(FILE *fp);
+void streamDecompress40(FILE *fp);
+
+#endif
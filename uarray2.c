@@ -135,6 +135,30 @@ void *UArray2_at(T uarray2, int col, int row)
         return UArray_at(uarray2->Uarray, col + row * uarray2->width);
 }
 
+/*
+ * Name: UArray2_row
+ * Description: Accesses a whole row of the given UArray at once. The elements
+ *              of a row are contiguous, UArray2_size bytes apart, so a row can
+ *              be walked with a pointer instead of calling UArray2_at for 
+ *              each element.
+ * Input: 
+ *      T uarray2 : A pointer to a uarray2
+ *        int row : integer row to access
+ * Returns: A void pointer to the element at col 0 of the row (NULL when the 
+ *          width is 0)
+ * Expectations: row is within the boundaries of the UArray (height < row >= 
+ *               0) and the given array pointer is not null; CRE if not
+ */
+void *UArray2_row(T uarray2, int row) 
+{
+        assert(uarray2 != NULL);
+        assert(row < uarray2->height && row >= 0);
+        if (uarray2->width == 0) {
+                return NULL;
+        }
+        return UArray_at(uarray2->Uarray, row * uarray2->width);
+}
+
 /*
  * Name: UArray_map_row_major
  * Description: Iterates through the UArray and applies the given function row 
@@ -160,9 +184,15 @@ void UArray2_map_row_major(T uarray2, void apply(int col, int row, T a,
 {
         assert(uarray2 != NULL);
         assert(apply != NULL);
+        if (uarray2->width == 0) {
+                return;
+        }
+        int size = UArray2_size(uarray2);
         for (int row_i = 0; row_i < uarray2->height; ++row_i) {
+                char *elem = UArray2_row(uarray2, row_i);
                 for (int col_i = 0; col_i < uarray2->width; ++col_i) {
-                        apply(col_i, row_i, uarray2, UArray2_at(uarray2, col_i, row_i), cl);
+                        apply(col_i, row_i, uarray2, elem, cl);
+                        elem += size;
                 }
         }
 }
@@ -191,9 +221,19 @@ void UArray2_map_col_major(T uarray2, void apply(int col, int row, T a,
 {
         assert(uarray2 != NULL);
         assert(apply != NULL);
+        if (uarray2->width == 0 || uarray2->height == 0) {
+                return;
+        }
+        
+        /* the rows follow each other, so a column is width elements apart */
+        int size = UArray2_size(uarray2);
+        size_t rowBytes = (size_t)uarray2->width * size;
+        char *first = UArray2_row(uarray2, 0);
         for (int col_i = 0; col_i < uarray2->width; ++col_i) {
+                char *elem = first + (size_t)col_i * size;
                 for (int row_i = 0; row_i < uarray2->height; ++row_i) {
-                        apply(col_i, row_i, uarray2, UArray2_at(uarray2, col_i, row_i), cl);
+                        apply(col_i, row_i, uarray2, elem, cl);
+                        elem += rowBytes;
                 }
         }
 }
@@ -22,6 +22,7 @@ int UArray2_height(T UArray);
 int UArray2_width(T UArray);
 int UArray2_size(T UArray);
 void *UArray2_at(T UArray, int col, int row);
+void *UArray2_row(T UArray, int row);
 void UArray2_map_row_major(T uarray2, 
                            void apply(int row, int col, T a, void *value, 
                            void*cl), 
@@ -0,0 +1,229 @@
+/*
+ * Assignment: arith
+ * Name: uarray2b.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/28/23
+ * Summary: Implementation of the blocked 2d array (UArray2b_T). Every block 
+ *          is stored contiguously (its cells row major) in one allocation, 
+ *          and the blocks follow each other row major. Blocks on the right 
+ *          or bottom edge are allocated whole even if part of them is outside
+ *          the array.
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "uarray2b.h"
+#include "assert.h"
+#include "mem.h"
+
+#define T UArray2b_T
+
+/* the most bytes a block made by UArray2b_new_64K_block may take */
+static const int BLOCK_BYTES_64K = 64 * 1024;
+
+struct T {
+        int width, height;              /* size in cells */
+        int size;                       /* bytes per cell */
+        int blocksize;                  /* cells along each side of a block */
+        int blocksWide;                 /* number of blocks across a row */
+        size_t blockBytes;              /* bytes per block */
+        char *elems;
+};
+
+
+/*
+ * Name: UArray2b_new
+ * Description: Create a blocked 2d array of width by height cells of the 
+ *              given byte size, cut into blocks of blocksize by blocksize 
+ *              cells. Every cell starts zeroed.
+ * Returns: A pointer to the new UArray2b
+ * Input:
+ *          int width : The width of the array in cells
+ *         int height : The height of the array in cells
+ *           int size : The byte size of a cell
+ *      int blocksize : The number of cells along each side of a block
+ * Expectations: width and height are not negative and size and blocksize are
+ *               positive. CRE if not.
+ * Note: User is responsible to free the array (UArray2b_free)
+ */
+T UArray2b_new(int width, int height, int size, int blocksize)
+{
+        assert(width >= 0 && height >= 0);
+        assert(size > 0 && blocksize > 0);
+
+        T array2b;
+        NEW(array2b);
+        array2b->width = width;
+        array2b->height = height;
+        array2b->size = size;
+        array2b->blocksize = blocksize;
+        array2b->blocksWide = (width + blocksize - 1) / blocksize;
+        array2b->blockBytes = (size_t)blocksize * blocksize * size;
+
+        size_t blocksHigh = (height + blocksize - 1) / blocksize;
+        size_t blocks = blocksHigh * array2b->blocksWide;
+        array2b->elems = CALLOC(blocks > 0 ? blocks : 1, array2b->blockBytes);
+
+        return array2b;
+}
+
+/*
+ * Name: UArray2b_new_64K_block
+ * Description: Create a blocked 2d array whose blocks are as large as they 
+ *              can be while still fitting in 64KB (1 cell if a cell alone is
+ *              larger)
+ * Returns: A pointer to the new UArray2b
+ * Input:
+ *          int width : The width of the array in cells
+ *         int height : The height of the array in cells
+ *           int size : The byte size of a cell
+ * Expectations: As UArray2b_new
+ * Note: User is responsible to free the array (UArray2b_free)
+ */
+T UArray2b_new_64K_block(int width, int height, int size)
+{
+        assert(size > 0);
+        int blocksize = sqrt(BLOCK_BYTES_64K / size);
+        return UArray2b_new(width, height, size, blocksize > 0 ? blocksize 
+                                                               : 1);
+}
+
+/*
+ * Name: UArray2b_free
+ * Description: Free the given array and its cells
+ * Input:
+ *      T *array2b : A pointer to the array to free
+ * Returns: n/a
+ * Effects: *array2b is set to NULL
+ * Expectations: CRE when the pointer or the array is NULL
+ */
+void UArray2b_free(T *array2b)
+{
+        assert(array2b != NULL && *array2b != NULL);
+        FREE((*array2b)->elems);
+        FREE(*array2b);
+}
+
+/*
+ * Name: UArray2b_width
+ * Description: Get the width of the given array
+ * Input:
+ *      T array2b : The array
+ * Returns: The width in cells
+ * Expectations: CRE when the array is NULL
+ */
+int UArray2b_width(T array2b)
+{
+        assert(array2b != NULL);
+        return array2b->width;
+}
+
+/*
+ * Name: UArray2b_height
+ * Description: Get the height of the given array
+ * Input:
+ *      T array2b : The array
+ * Returns: The height in cells
+ * Expectations: CRE when the array is NULL
+ */
+int UArray2b_height(T array2b)
+{
+        assert(array2b != NULL);
+        return array2b->height;
+}
+
+/*
+ * Name: UArray2b_size
+ * Description: Get the byte size of a cell of the given array
+ * Input:
+ *      T array2b : The array
+ * Returns: The byte size of a cell
+ * Expectations: CRE when the array is NULL
+ */
+int UArray2b_size(T array2b)
+{
+        assert(array2b != NULL);
+        return array2b->size;
+}
+
+/*
+ * Name: UArray2b_blocksize
+ * Description: Get the number of cells along each side of a block of the 
+ *              given array
+ * Input:
+ *      T array2b : The array
+ * Returns: The block size
+ * Expectations: CRE when the array is NULL
+ */
+int UArray2b_blocksize(T array2b)
+{
+        assert(array2b != NULL);
+        return array2b->blocksize;
+}
+
+/*
+ * Name: UArray2b_at
+ * Description: Get the cell at the given column and row
+ * Input:
+ *      T array2b : The array
+ *        int col : The column of the cell
+ *        int row : The row of the cell
+ * Returns: A pointer to the cell
+ * Expectations: The array isn't NULL and col and row are inside it. CRE if 
+ *               not.
+ */
+void *UArray2b_at(T array2b, int col, int row)
+{
+        assert(array2b != NULL);
+        assert(col >= 0 && col < array2b->width);
+        assert(row >= 0 && row < array2b->height);
+
+        int bs = array2b->blocksize;
+        size_t block = (size_t)(row / bs) * array2b->blocksWide + col / bs;
+        size_t cell = (row % bs) * bs + col % bs;
+        return array2b->elems + block * array2b->blockBytes + 
+               cell * array2b->size;
+}
+
+/*
+ * Name: UArray2b_map
+ * Description: Apply the given function to every cell of the array one block
+ *              at a time (blocks row major, and the cells of each block row 
+ *              major), which visits the cells in the order they are stored
+ * Input:
+ *      T array2b : The array
+ *      void apply : The function to apply to each cell, given its column,
+ *                   row, the array, a pointer to the cell and cl
+ *      void *cl : A closure passed to every call of apply
+ * Returns: n/a
+ * Effects: Whatever apply does. Cells of the edge blocks that are outside 
+ *          the array are skipped.
+ * Expectations: CRE when the array or apply is NULL
+ */
+void UArray2b_map(T array2b, 
+                  void apply(int col, int row, T array2b, void *elem, 
+                             void *cl), 
+                  void *cl)
+{
+        assert(array2b != NULL);
+        assert(apply != NULL);
+
+        int bs = array2b->blocksize;
+        char *block = array2b->elems;
+        for (int top = 0; top < array2b->height; top += bs) {
+                for (int left = 0; left < array2b->width; left += bs) {
+                        for (int cell = 0; cell < bs * bs; ++cell) {
+                                int col = left + cell % bs;
+                                int row = top + cell / bs;
+                                if (col < array2b->width && 
+                                    row < array2b->height) {
+                                        apply(col, row, array2b, block + 
+                                              cell * array2b->size, cl);
+                                }
+                        }
+                        block += array2b->blockBytes;
+                }
+        }
+}
+
+#undef T
@@ -0,0 +1,58 @@
+/*
+ * Assignment: arith
+ * Name: uarray2b.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/28/23
+ * Summary: Interface for the blocked 2d array (UArray2b_T). The array is cut 
+ *          into square blocks of blocksize by blocksize cells, and the cells 
+ *          of each block are stored next to each other, so a block can be 
+ *          worked on without leaving a few cache lines.
+*/
+
+#ifndef UARRAY2B_H_INCLUDED
+#define UARRAY2B_H_INCLUDED
+
+#define T UArray2b_T
+typedef struct T *T;
+
+T UArray2b_new(int width, int height, int size, int blocksize);
+T UArray2b_new_64K_block(int width, int height, int size);
+void UArray2b_free(T *array2b);
+int UArray2b_width(T array2b);
+int UArray2b_height(T array2b);
+int UArray2b_size(T array2b);
+int UArray2b_blocksize(T array2b);
+void *UArray2b_at(T array2b, int col, int row);
+void UArray2b_map(T array2b, 
+                  void apply(int col, int row, T array2b, void *elem, 
+                             void *cl), 
+                  void *cl);
+
+#undef T
+
+/*
+ * UARRAY2B_DEFINE_MAP_BLOCKS(name, apply, Closure) defines 
+ * 
+ *      static void name(UArray2b_T array2b, Closure *cl)
+ *
+ * which visits the blocks of the array in the order UArray2b_map does and 
+ * calls apply(col, row, block, cl) once per block, where col and row are of 
+ * the block's top left cell and block points at its blocksize * blocksize 
+ * contiguous cells (edge blocks included whole). apply is called directly 
+ * rather than through a pointer, so a static inline apply is inlined into 
+ * the loop. Use it for hot maps; UArray2b_map (and A2Methods) for the rest.
+ */
+#define UARRAY2B_DEFINE_MAP_BLOCKS(name, apply, Closure)                      \
+static void name(UArray2b_T array2b, Closure *cl)                             \
+{                                                                             \
+        int bs = UArray2b_blocksize(array2b);                                 \
+        int width = UArray2b_width(array2b);                                  \
+        int height = UArray2b_height(array2b);                                \
+        for (int row = 0; row < height; row += bs) {                          \
+                for (int col = 0; col < width; col += bs) {                   \
+                        apply(col, row, UArray2b_at(array2b, col, row), cl);  \
+                }                                                             \
+        }                                                                     \
+}
+
+#endif
@@ -0,0 +1,153 @@
+/*
+ * Assignment: arith
+ * Name: wordFields.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/27/23
+ * Summary: Provides inline versions of the Bitpack get and new functions for
+ *          the fields of a codeWord, plus functions that pack or unpack every
+ *          field of the packInfo.h layout at once. The widths and lsbs are
+ *          constants and every quantized value already fits its field, so
+ *          each field is just a shift and a mask. Building with
+ *          -DCHECKED_BITPACK sends every field through the checked Bitpack
+ *          interface instead, to validate the layout and the quantizer.
+*/
+
+#ifndef WORDFIELDS_H_INCLUDED
+#define WORDFIELDS_H_INCLUDED
+
+#include <stdint.h>
+#include "codeWord.h"
+#include "packInfo.h"
+#if defined(CHECKED_BITPACK)
+#include "bitpack.h"
+#endif
+
+/*
+ * Name: fieldMask
+ * Purpose: Make a mask of the given number of low bits
+ * Parameters:
+ *      int width : The number of bits, less than WORD_BIT_LENGTH
+ * Output: The mask
+ */
+static inline codeWord fieldMask(int width)
+{
+        return ((codeWord)1 << width) - 1;
+}
+
+/*
+ * Name: fieldGetu
+ * Purpose: Get the unsigned field at the given width and lsb of a word
+ * Parameters:
+ *      codeWord word : The word holding the field
+ *          int width : The width of the field in bits
+ *            int lsb : The least significant bit of the field
+ * Output: The value of the field
+ */
+static inline uint64_t fieldGetu(codeWord word, int width, int lsb)
+{
+#if defined(CHECKED_BITPACK)
+        return Bitpack_getu(word, width, lsb);
+#else
+        return (word >> lsb) & fieldMask(width);
+#endif
+}
+
+/*
+ * Name: fieldGets
+ * Purpose: Get the signed (two's complement) field at the given width and
+ *          lsb of a word
+ * Parameters:
+ *      codeWord word : The word holding the field
+ *          int width : The width of the field in bits
+ *            int lsb : The least significant bit of the field
+ * Output: The value of the field, sign extended
+ */
+static inline int64_t fieldGets(codeWord word, int width, int lsb)
+{
+#if defined(CHECKED_BITPACK)
+        return Bitpack_gets(word, width, lsb);
+#else
+        int64_t sign = (int64_t)1 << (width - 1);
+        return ((int64_t)fieldGetu(word, width, lsb) ^ sign) - sign;
+#endif
+}
+
+/*
+ * Name: fieldNewu
+ * Purpose: Put an unsigned value in the given field of a word
+ * Parameters:
+ *       codeWord word : The word to put the value in
+ *           int width : The width of the field in bits
+ *             int lsb : The least significant bit of the field
+ *      uint64_t value : The value, which must fit in width bits
+ * Output: The word with the field replaced
+ */
+static inline codeWord fieldNewu(codeWord word, int width, int lsb,
+                                 uint64_t value)
+{
+#if defined(CHECKED_BITPACK)
+        return Bitpack_newu(word, width, lsb, value);
+#else
+        codeWord mask = fieldMask(width) << lsb;
+        return (word & ~mask) | (((codeWord)value << lsb) & mask);
+#endif
+}
+
+/*
+ * Name: fieldNews
+ * Purpose: Put a signed value in the given field of a word (two's complement)
+ * Parameters:
+ *      codeWord word : The word to put the value in
+ *          int width : The width of the field in bits
+ *            int lsb : The least significant bit of the field
+ *      int64_t value : The value, which must fit in width bits
+ * Output: The word with the field replaced
+ */
+static inline codeWord fieldNews(codeWord word, int width, int lsb,
+                                 int64_t value)
+{
+#if defined(CHECKED_BITPACK)
+        return Bitpack_news(word, width, lsb, value);
+#else
+        return fieldNewu(word, width, lsb, (uint64_t)value);
+#endif
+}
+
+/*
+ * Name: packFields
+ * Purpose: Pack every quantized value into its field of a new word
+ * Parameters:
+ *      const struct quantizedVals *qVals : The quantized values of a block
+ * Output: The packed word
+ */
+static inline codeWord packFields(const struct quantizedVals *qVals)
+{
+        codeWord word = 0;
+        word = fieldNewu(word, A_WIDTH, A_LSB, qVals->qA);
+        word = fieldNews(word, B_WIDTH, B_LSB, qVals->qB);
+        word = fieldNews(word, C_WIDTH, C_LSB, qVals->qC);
+        word = fieldNews(word, D_WIDTH, D_LSB, qVals->qD);
+        word = fieldNewu(word, PB_WIDTH, PB_LSB, qVals->pbChroma);
+        word = fieldNewu(word, PR_WIDTH, PR_LSB, qVals->prChroma);
+        return word;
+}
+
+/*
+ * Name: unpackFields
+ * Purpose: Get every quantized value out of its field of a word
+ * Parameters:
+ *                    codeWord word : The packed word
+ *      struct quantizedVals *qVals : The struct to store the values in
+ * Output: n/a
+ */
+static inline void unpackFields(codeWord word, struct quantizedVals *qVals)
+{
+        qVals->qA = fieldGetu(word, A_WIDTH, A_LSB);
+        qVals->qB = fieldGets(word, B_WIDTH, B_LSB);
+        qVals->qC = fieldGets(word, C_WIDTH, C_LSB);
+        qVals->qD = fieldGets(word, D_WIDTH, D_LSB);
+        qVals->pbChroma = fieldGetu(word, PB_WIDTH, PB_LSB);
+        qVals->prChroma = fieldGetu(word, PR_WIDTH, PR_LSB);
+}
+
+#endif
@@ -0,0 +1,575 @@
+/*
+ * Assignment: arith
+ * Name: wordIO.c
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/24/23
+ * Summary: Reads and writes the header and codeWords of a compressed image.
+ *          Words are read in bulk and converted to host order with vector 
+ *          byte shuffles, or mapped straight from the file and used in place.
+ *          Words being printed are byte swapped a row at a time into a large 
+ *          aligned buffer that is written out with a single fwrite once it 
+ *          fills. Images may also be written in a native variant of the 
+ *          format (host byte order, payload aligned to 4 bytes) that needs 
+ *          no swapping at all on hosts with the same byte order.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "wordIO.h"
+#include "mem.h"
+#include "assert.h"
+
+/* first line of the header of each variant of the format */
+static const char BIG_ENDIAN_MAGIC[] = "COMP40 Compressed image format 2\n";
+static const char NATIVE_MAGIC[] = "COMP40 Compressed image format 2 native\n";
+
+/* word after the native header, tells the reader the byte order used */
+static const codeWord BYTE_ORDER_MARK = 0x01020304;
+
+/* whether the host stores words most significant byte first */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static const bool HOST_BIG_ENDIAN = true;
+#else
+static const bool HOST_BIG_ENDIAN = false;
+#endif
+
+/* size and alignment of the buffer of a wordWriter */
+static const size_t WRITE_BUFFER_BYTES = 1 << 20;
+static const size_t WRITE_BUFFER_ALIGN = 64;
+
+#if defined(__SSE2__)
+/* number of words swapped at once by a 128 bit vector */
+static const size_t WORDS_PER_VECTOR = 4;
+#endif
+
+/* whether compressed images are written in the native variant */
+static bool nativeWords = false;
+
+struct wordWriter {
+        FILE *fp;
+        unsigned char *buffer;
+        size_t used;
+};
+
+/* helper functions */
+static void swapWords(const unsigned char *in, unsigned char *out, size_t n);
+static void flushWords(struct wordWriter *writer);
+
+
+/*******************************************************************************
+*                          Header Functions                                    *
+*******************************************************************************/
+
+/*
+ * Name: useNativeWords
+ * Purpose: Choose which variant of the format compressed images are written
+ *          in
+ * Parameters:
+ *      bool native : true for host byte order with an aligned payload, false 
+ *                    for the standard big endian format
+ * Output: n/a
+ * Effects: Every header and word written afterwards uses the chosen variant
+ */
+void useNativeWords(bool native)
+{
+        nativeWords = native;
+}
+
+/*
+ * Name: writeWordHeader
+ * Purpose: Print the header of a compressed image of the given size
+ * Parameters:
+ *             FILE *fp : The file to print the header to
+ *       unsigned width : The width of the image
+ *      unsigned height : The height of the image
+ * Output: n/a
+ * Effects: The header is printed. In the native variant it is padded with 
+ *          0 bytes to a multiple of 4 and followed by the byte order mark so 
+ *          the payload is aligned.
+ */
+void writeWordHeader(FILE *fp, unsigned width, unsigned height)
+{
+        if (!nativeWords) {
+                fprintf(fp, "%s%u %u\n", BIG_ENDIAN_MAGIC, width, height);
+                return;
+        }
+
+        int length = fprintf(fp, "%s%u %u\n", NATIVE_MAGIC, width, height);
+        for (; length % sizeof(codeWord) != 0; ++length) {
+                putc('\0', fp);
+        }
+        fwrite(&BYTE_ORDER_MARK, sizeof(codeWord), 1, fp);
+}
+
+/*
+ * Name: readWordHeader
+ * Purpose: Read the header of a compressed image in either variant of the 
+ *          format and leave the file at the first byte of the payload
+ * Parameters:
+ *              FILE *fp : The compressed file to read from
+ *       unsigned *width : Where to store the width of the image
+ *      unsigned *height : Where to store the height of the image
+ * Output: true if the words in the payload have to be byte swapped to be in
+ *         host order, false if they can be used as they are
+ * Effects: The header is consumed from fp
+ * Expectations: The given file pointer is formatted correctly. CRE if not.
+ */
+bool readWordHeader(FILE *fp, unsigned *width, unsigned *height)
+{
+        bool swap;
+        bool read = tryReadWordHeader(fp, width, height, &swap);
+        assert(read);
+        return swap;
+}
+
+/*
+ * Name: tryReadWordHeader
+ * Purpose: readWordHeader for a file that may not be a compressed image
+ * Parameters:
+ *              FILE *fp : The file to read from
+ *       unsigned *width : Where to store the width of the image
+ *      unsigned *height : Where to store the height of the image
+ *            bool *swap : Where to store whether the words have to be byte
+ *                         swapped to be in host order
+ * Output: true if the file starts with a header of either variant, false if
+ *         not
+ * Effects: The header is consumed from fp (how much of a bad header is 
+ *          consumed is unspecified)
+ */
+bool tryReadWordHeader(FILE *fp, unsigned *width, unsigned *height, 
+                       bool *swap)
+{
+        /* read the first line and find out which variant it is */
+        char magic[sizeof(NATIVE_MAGIC)];
+        if (fgets(magic, sizeof(magic), fp) == NULL) {
+                return false;
+        }
+        bool native = strcmp(magic, NATIVE_MAGIC) == 0;
+        if (!native && strcmp(magic, BIG_ENDIAN_MAGIC) != 0) {
+                return false;
+        }
+
+        /* read the dimensions */
+        int length = 0;
+        if (fscanf(fp, "%u %u%n", width, height, &length) != 2 || 
+            getc(fp) != '\n') {
+                return false;
+        }
+        if (!native) {
+                *swap = !HOST_BIG_ENDIAN;
+                return true;
+        }
+
+        /* skip the padding and check the byte order the words are in */
+        length += strlen(magic) + 1;
+        for (; length % sizeof(codeWord) != 0; ++length) {
+                if (getc(fp) != '\0') {
+                        return false;
+                }
+        }
+        codeWord mark;
+        if (fread(&mark, sizeof(codeWord), 1, fp) != 1 || 
+            (mark != BYTE_ORDER_MARK && 
+             mark != __builtin_bswap32(BYTE_ORDER_MARK))) {
+                return false;
+        }
+
+        *swap = mark != BYTE_ORDER_MARK;
+        return true;
+}
+
+
+/*******************************************************************************
+*                            Reading Functions                                 *
+*******************************************************************************/
+
+/*
+ * Name: readWords
+ * Purpose: Read the next n words of the given file into the given array in
+ *          host order with a single read
+ * Parameters:
+ *             FILE *fp : The open file of packed words
+ *      codeWord *words : The array of words to read into
+ *             size_t n : The number of words to read
+ *            bool swap : Whether the words need swapping (from 
+ *                        readWordHeader)
+ * Output: n/a
+ * Effects: The array holds the next n words of the file
+ * Expectations: The file has n words left. CRE if not.
+ */
+void readWords(FILE *fp, codeWord *words, size_t n, bool swap)
+{
+        /* read the raw bytes straight into the words and swap them there */
+        size_t read = fread(words, sizeof(codeWord), n, fp);
+        assert(read == n);
+        wordsToHost((unsigned char *)words, words, n, swap);
+}
+
+/*
+ * Name: wordsToHost
+ * Purpose: Build n host order words out of the bytes of n words read from a
+ *          compressed file
+ * Parameters:
+ *      const unsigned char *bytes : The bytes of the words
+ *                 codeWord *words : The array to store the words in (may be
+ *                                   the same memory as bytes)
+ *                        size_t n : The number of words to convert
+ *                       bool swap : Whether the words need swapping (from 
+ *                                   readWordHeader)
+ * Output: n/a
+ * Effects: The words array holds the n words in host order
+ */
+void wordsToHost(const unsigned char *bytes, codeWord *words, size_t n, 
+                 bool swap)
+{
+        if (swap) {
+                swapWords(bytes, (unsigned char *)words, n);
+        } else if (bytes != (unsigned char *)words) {
+                memmove(words, bytes, n * sizeof(codeWord));
+        }
+}
+
+/*
+ * Name: openWordView
+ * Purpose: Get at every word of a compressed image whose header has been 
+ *          read. A regular file is mapped into memory and its words are used
+ *          where they lie, anything else (a pipe) is read into memory.
+ * Parameters:
+ *                  FILE *fp : The compressed file, positioned at the payload
+ *            unsigned width : The width of the image (from the header)
+ *           unsigned height : The height of the image (from the header)
+ *                 bool swap : Whether the words need swapping (from 
+ *                             readWordHeader)
+ *      struct wordView *view : The view to set up
+ * Output: n/a
+ * Notes: The view must be closed by the caller (closeWordView())
+ * Expectations: The file holds every word of the image. CRE if not.
+ */
+void openWordView(FILE *fp, unsigned width, unsigned height, bool swap, 
+                  struct wordView *view)
+{
+        bool opened = tryOpenWordView(fp, width, height, swap, view);
+        assert(opened);
+}
+
+/*
+ * Name: tryOpenWordView
+ * Purpose: openWordView for a file whose payload may be cut short
+ * Parameters:
+ *                  FILE *fp : The compressed file, positioned at the payload
+ *            unsigned width : The width of the image (from the header)
+ *           unsigned height : The height of the image (from the header)
+ *                 bool swap : Whether the words need swapping
+ *      struct wordView *view : The view to set up
+ * Output: true if the view was set up, false if the file doesn't hold every
+ *         word of the image (nothing is left to close then)
+ * Notes: A view that was set up must be closed by the caller 
+ *        (closeWordView())
+ */
+bool tryOpenWordView(FILE *fp, unsigned width, unsigned height, bool swap, 
+                     struct wordView *view)
+{
+        view->cols = width / BLOCK_LENGTH;
+        view->rows = height / BLOCK_LENGTH;
+        view->swap = swap;
+        view->mapping = NULL;
+        view->mappedBytes = 0;
+        size_t payloadBytes = (size_t)view->cols * view->rows * 
+                              sizeof(codeWord);
+
+        /* map a regular file and point straight at its payload */
+        struct stat info;
+        off_t payload = ftello(fp);
+        if (payloadBytes > 0 && payload >= 0 && 
+            fstat(fileno(fp), &info) == 0 && S_ISREG(info.st_mode)) {
+                if (info.st_size < payload || 
+                    (size_t)(info.st_size - payload) < payloadBytes) {
+                        return false;
+                }
+                void *mapping = mmap(NULL, info.st_size, PROT_READ, 
+                                     MAP_PRIVATE, fileno(fp), 0);
+                if (mapping != MAP_FAILED) {
+                        madvise(mapping, info.st_size, MADV_SEQUENTIAL);
+                        view->mapping = mapping;
+                        view->mappedBytes = info.st_size;
+                        view->words = (unsigned char *)mapping + payload;
+                        return true;
+                }
+        }
+
+        /* otherwise read the payload in, already in host order */
+        size_t n = payloadBytes / sizeof(codeWord);
+        unsigned char *words = ALLOC(payloadBytes + 1);
+        if (fread(words, sizeof(codeWord), n, fp) != n) {
+                FREE(words);
+                return false;
+        }
+        wordsToHost(words, (codeWord *)words, n, swap);
+        view->words = words;
+        view->swap = false;
+        return true;
+}
+
+/*
+ * Name: wordAt
+ * Purpose: Get the word of the block at the given col and row of the view in
+ *          host order
+ * Parameters:
+ *      const struct wordView *view : The view of the words
+ *                          int col : The column of the block
+ *                          int row : The row of the block
+ * Output: The word in host order
+ */
+codeWord wordAt(const struct wordView *view, int col, int row)
+{
+        /* memcpy because a mapped payload might not be aligned */
+        codeWord word;
+        size_t index = (size_t)row * view->cols + col;
+        memcpy(&word, view->words + index * sizeof(codeWord), 
+               sizeof(codeWord));
+        return view->swap ? __builtin_bswap32(word) : word;
+}
+
+/*
+ * Name: closeWordView
+ * Purpose: Unmap or free the words of the given view
+ * Parameters:
+ *      struct wordView *view : The view to close
+ * Output: n/a
+ */
+void closeWordView(struct wordView *view)
+{
+        if (view->mapping != NULL) {
+                munmap(view->mapping, view->mappedBytes);
+        } else {
+                FREE(view->words);
+        }
+        view->words = NULL;
+}
+
+
+/*******************************************************************************
+*                            Writing Functions                                 *
+*******************************************************************************/
+
+/*
+ * Name: wordsToBigEndian
+ * Purpose: Store n host order words as the bytes of n big endian words
+ * Parameters:
+ *      const codeWord *words : The words to convert
+ *       unsigned char *bytes : Where to store the big endian bytes (may be 
+ *                              the same memory as words)
+ *                   size_t n : The number of words to convert
+ * Output: n/a
+ * Effects: bytes holds the n words most significant byte first
+ */
+void wordsToBigEndian(const codeWord *words, unsigned char *bytes, size_t n)
+{
+        if (!HOST_BIG_ENDIAN) {
+                swapWords((const unsigned char *)words, bytes, n);
+        } else if (bytes != (const unsigned char *)words) {
+                memmove(bytes, words, n * sizeof(codeWord));
+        }
+}
+
+/*
+ * Name: writeWordsInPlace
+ * Purpose: Print n words to the given file in one write, converting them to
+ *          big endian where they lie (nothing to convert in the native 
+ *          variant) instead of through a wordWriter's buffer
+ * Parameters:
+ *             FILE *fp : The file to print the words to
+ *      codeWord *words : The words to print, in host order
+ *             size_t n : The number of words
+ * Output: n/a
+ * Effects: The words are written to fp. They are left in the file's byte 
+ *          order, so the array no longer holds host order words.
+ * Expectations: Every word can be written. CRE if not.
+ */
+void writeWordsInPlace(FILE *fp, codeWord *words, size_t n)
+{
+        if (!nativeWords) {
+                wordsToBigEndian(words, (unsigned char *)words, n);
+        }
+        size_t written = fwrite(words, sizeof(codeWord), n, fp);
+        assert(written == n);
+}
+
+/*
+ * Name: newWordWriter
+ * Purpose: Create a writer that prints words to the given file through a 
+ *          large buffer, in big endian order (or host order in the native 
+ *          variant)
+ * Parameters:
+ *      FILE *fp : The file to print the words to
+ * Output: The new writer
+ * Notes: The writer must be freed (which flushes it) with freeWordWriter()
+ */
+struct wordWriter *newWordWriter(FILE *fp)
+{
+        struct wordWriter *writer;
+        NEW(writer);
+        writer->fp = fp;
+        writer->used = 0;
+
+        void *buffer = NULL;
+        int err = posix_memalign(&buffer, WRITE_BUFFER_ALIGN, 
+                                 WRITE_BUFFER_BYTES);
+        assert(err == 0);
+        writer->buffer = buffer;
+
+        return writer;
+}
+
+/*
+ * Name: writeWords
+ * Purpose: Add the given words to the writer, writing out the buffer each 
+ *          time it fills
+ * Parameters:
+ *      struct wordWriter *writer : The writer to add the words to
+ *          const codeWord *words : The words to print
+ *                       size_t n : The number of words to print
+ * Output: n/a
+ * Effects: The words are in the buffer or have been written to the file
+ */
+void writeWords(struct wordWriter *writer, const codeWord *words, size_t n)
+{
+        while (n > 0) {
+                /* swap as many words as fit into the buffer */
+                size_t room = (WRITE_BUFFER_BYTES - writer->used) / 
+                              sizeof(codeWord);
+                size_t chunk = n < room ? n : room;
+                if (nativeWords) {
+                        memcpy(writer->buffer + writer->used, words, 
+                               chunk * sizeof(codeWord));
+                } else {
+                        wordsToBigEndian(words, writer->buffer + writer->used,
+                                         chunk);
+                }
+                writer->used += chunk * sizeof(codeWord);
+                words += chunk;
+                n -= chunk;
+
+                if (writer->used + sizeof(codeWord) > WRITE_BUFFER_BYTES) {
+                        flushWords(writer);
+                }
+        }
+}
+
+/*
+ * Name: freeWordWriter
+ * Purpose: Write out whatever is left in the writer and free it
+ * Parameters:
+ *      struct wordWriter **writer : A pointer to the writer to free
+ * Output: n/a
+ * Effects: Every word given to the writer has been written and *writer is 
+ *          set to NULL
+ */
+void freeWordWriter(struct wordWriter **writer)
+{
+        assert(writer != NULL && *writer != NULL);
+        flushWords(*writer);
+        free((*writer)->buffer);
+        FREE(*writer);
+}
+
+/*
+ * Name: printWordArray
+ * Purpose: Print every word in the given array to stdout through a 
+ *          wordWriter, row by row
+ * Parameters:
+ *      A2Methods_UArray2 packed : The array of packed words
+ *         A2Methods_T methods : The methods of the packed array
+ * Output: n/a
+ * Effects: The words are printed out most significant byte to least
+ * Expectations: The array is a plain UArray2, whose rows are contiguous
+ */
+void printWordArray(A2Methods_UArray2 packed, A2Methods_T methods)
+{
+        int width = methods->width(packed);
+        int height = methods->height(packed);
+        if (width == 0) {
+                return;
+        }
+
+        struct wordWriter *writer = newWordWriter(stdout);
+        for (int row = 0; row < height; ++row) {
+                writeWords(writer, methods->at(packed, 0, row), width);
+        }
+        freeWordWriter(&writer);
+}
+
+
+/*******************************************************************************
+*                            Helper Functions                                  *
+*******************************************************************************/
+
+/*
+ * Name: swapWords
+ * Purpose: Reverse the byte order of n words. The bytes of 4 words are
+ *          reversed at once with a vector shuffle when the compiler targets
+ *          SSSE3 or SSE2.
+ * Parameters:
+ *      const unsigned char *in : The bytes of the words to convert
+ *           unsigned char *out : Where to put the converted words (may be 
+ *                                the same memory as in)
+ *                     size_t n : The number of words to convert
+ * Output: n/a
+ */
+void swapWords(const unsigned char *in, unsigned char *out, size_t n)
+{
+        size_t w = 0;
+
+#if defined(__SSSE3__)
+        /* reverse the bytes of each 32 bit lane with a single shuffle */
+        const __m128i order = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 
+                                            11, 10, 9, 8, 15, 14, 13, 12);
+        for (; w + WORDS_PER_VECTOR <= n; w += WORDS_PER_VECTOR) {
+                __m128i v = _mm_loadu_si128((const __m128i *)(in + w * 4));
+                v = _mm_shuffle_epi8(v, order);
+                _mm_storeu_si128((__m128i *)(out + w * 4), v);
+        }
+#elif defined(__SSE2__)
+        /* swap the bytes of each 16 bit half, then swap the halves */
+        for (; w + WORDS_PER_VECTOR <= n; w += WORDS_PER_VECTOR) {
+                __m128i v = _mm_loadu_si128((const __m128i *)(in + w * 4));
+                v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+                v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+                v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+                _mm_storeu_si128((__m128i *)(out + w * 4), v);
+        }
+#endif
+
+        /* swap whatever is left one word at a time */
+        for (; w < n; ++w) {
+                codeWord word;
+                memcpy(&word, in + w * sizeof(codeWord), sizeof(codeWord));
+                word = __builtin_bswap32(word);
+                memcpy(out + w * sizeof(codeWord), &word, sizeof(codeWord));
+        }
+}
+
+/*
+ * Name: flushWords
+ * Purpose: Write out every byte in the writer's buffer and empty it
+ * Parameters:
+ *      struct wordWriter *writer : The writer to flush
+ * Output: n/a
+ * Expectations: The file accepts every byte. CRE if not.
+ */
+void flushWords(struct wordWriter *writer)
+{
+        size_t written = fwrite(writer->buffer, 1, writer->used, writer->fp);
+        assert(written == writer->used);
+        writer->used = 0;
+}
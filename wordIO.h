@@ -0,0 +1,58 @@
+/*
+ * Assignment: arith
+ * Name: wordIO.h
+ * Authors: Tygan Chin (tchin02) & Emily Ye (eye03)
+ * Date: 10/24/23
+ * Summary: Provides functions to read and write the header and codeWords of a 
+ *          compressed image: bulk reads with conversion to host order, a 
+ *          view that maps a compressed file and uses its words in place, and
+ *          a buffered writer that prints rows of codeWords with one write per
+ *          megabyte. Also lets the caller choose a native variant of the 
+ *          format whose words need no byte swapping.
+*/
+
+#ifndef WORDIO_H_INCLUDED
+#define WORDIO_H_INCLUDED
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "codeWord.h"
+#include "a2methods.h"
+
+/* buffers words until a megabyte is ready to write */
+struct wordWriter;
+
+/* read only view of every word of a compressed image, mapped or in memory */
+struct wordView {
+        int cols, rows;                 /* size in blocks */
+        unsigned char *words;           /* the payload, row major */
+        bool swap;                      /* words aren't in host order */
+        void *mapping;                  /* the mapped file (or NULL) */
+        size_t mappedBytes;
+};
+
+void useNativeWords(bool native);
+void writeWordHeader(FILE *fp, unsigned width, unsigned height);
+bool readWordHeader(FILE *fp, unsigned *width, unsigned *height);
+bool tryReadWordHeader(FILE *fp, unsigned *width, unsigned *height, 
+                       bool *swap);
+
+void readWords(FILE *fp, codeWord *words, size_t n, bool swap);
+void wordsToHost(const unsigned char *bytes, codeWord *words, size_t n, 
+                 bool swap);
+void openWordView(FILE *fp, unsigned width, unsigned height, bool swap, 
+                  struct wordView *view);
+bool tryOpenWordView(FILE *fp, unsigned width, unsigned height, bool swap, 
+                     struct wordView *view);
+codeWord wordAt(const struct wordView *view, int col, int row);
+void closeWordView(struct wordView *view);
+
+void wordsToBigEndian(const codeWord *words, unsigned char *bytes, size_t n);
+void writeWordsInPlace(FILE *fp, codeWord *words, size_t n);
+struct wordWriter *newWordWriter(FILE *fp);
+void writeWords(struct wordWriter *writer, const codeWord *words, size_t n);
+void freeWordWriter(struct wordWriter **writer);
+void printWordArray(A2Methods_UArray2 packed, A2Methods_T methods);
+
+#endif